@@ -4,6 +4,9 @@
 
 #include <iostream>
 #include "plots.cxx"
+#include "dataset.cxx"
+#include "candidates.cxx"
+#include "kinematics.cxx"
 #include <string>
 #include <vector>
 #include <TFile.h>
@@ -37,9 +40,13 @@ std::string farm_out = (toFarm == true) ? "/farm_out/" : "/";
 //andrey_new_runs.dat.root
 // timothy_aao_norad_gen_Pi0P.root
 // clasdis_rga_fall18_inbending.root
+// a hipo2root --shard-dir directory works as well: all shards in its manifest.tsv are read as one dataset;
+// so do a glob ("../data/run_*.root"), a plain directory of .root files, a .list file or "a.root,b.root",
+// and so does a HIPO .dat list, read without converting, in a -DH2R_WITH_HIPO build (see dataset.cxx)
 
 
 std::string root_file_path = "../data/proton_electron_toy_simu.root";
+std::string tree_name = "";  // "": looked up in the first file, which also tells an RNTuple (--format=rntuple) from a TTree
 
 
 // Define the output folder as a constant
@@ -50,80 +57,48 @@ std::string root_file_path = "../data/proton_electron_toy_simu.root";
 // analysis_out_clasdis_rga_fall18_inbending
 
 
-const std::string OUTPUT_FOLDER = "../analysis_out_proton_electron_toy" + farm_out ;
+std::string OUTPUT_FOLDER = "../analysis_out_proton_electron_toy" + farm_out ;
 
 
-ROOT::RDataFrame convert_ttrees_to_rdataframe(const std::string &root_file_path) {
-    TFile *file = TFile::Open(root_file_path.c_str(), "READ");
-    if (!file || file->IsZombie()) {
-        std::cerr << "Error: Cannot open ROOT file " << root_file_path << std::endl;
-        return ROOT::RDataFrame(0);
-    }
-
-    std::vector<std::string> keys;
-    TIter next(file->GetListOfKeys());
-    TKey *key;
-    while ((key = (TKey *)next())) {
-        if (std::string(key->GetClassName()) == "TTree") {
-            keys.push_back(key->GetName());
-        }
-    }
-
-    if (keys.empty()) {
-        std::cerr << "No TTrees found in the ROOT file." << std::endl;
-        return ROOT::RDataFrame(0);
-    }
-
-    std::string tree_name = keys[0];
-    std::cout << "Processing TTree: " << tree_name << std::endl;
-
-    ROOT::RDataFrame rdf(tree_name, root_file_path);
-    file->Close();
-    return rdf;
-}
-
 // Use ROOT::RDF::RNode instead of RDataFrame& to fix type mismatch
 
 
 
-int main() {
+// ./executable [input] [output_folder/] [[alias=]friend...] overrides the two paths above;
+// each friend adds the columns of another file set of the same events, as alias.column
+// (or under their own names without alias=)
+int main(int argc, char** argv) {
     auto start = std::chrono::high_resolution_clock::now(); // STRAT
+    if (argc > 1) root_file_path = argv[1];
+    if (argc > 2) OUTPUT_FOLDER = argv[2];
 
     // Load ROOT file and convert TTrees to RDataFrame
     ROOT::EnableImplicitMT(); // Enable multi-threading
-    auto rdf = convert_ttrees_to_rdataframe(root_file_path);
+    std::vector<FriendFiles> friends;  // e.g. a derived-column file of the same events
+    for (int i = 3; i < argc; ++i) friends.push_back(friend_from_arg(argv[i]));
+    auto rdf = convert_ttrees_to_rdataframe(root_file_path, /*hipo_is_mc=*/true, tree_name, friends);
     if (rdf.GetColumnNames().empty()) {
         std::cerr << "Error: Could not create RDataFrame." << std::endl;
         return 1;
     }
+    // --schema=multi datasets: pick the proton/electron here (candidates.cxx)
+    auto events = select_candidates(rdf, true);
 
     // Define necessary variables in RDataFrame
     
-    auto init_rdf = rdf//.Filter(p_proton_gen > 0.0)
+    // four-vectors, angles, energies, Q2/nu/W/xB: one kin_rec / kin_gen per event;
+    // region, is_FD, is_CD of the proton (kinematics.cxx)
+    auto kinematics = kin::define_region(kin::define_kinematics(kin::define_kinematics(events, "rec"), "gen"));
+    auto init_rdf = kinematics//.Filter(p_proton_gen > 0.0)
                         //.Filter(p_proton_rec > 0.0)
-                        .Define("delta_p", "p_proton_rec - p_proton_gen")
-                        .Define("proton_rec_4_momentum", "TLorentzVector(px_prot_rec, py_prot_rec, pz_prot_rec, 0.938272)")// const number is mass of proton
-                        .Define("proton_gen_4_momentum", "TLorentzVector(px_prot_gen, py_prot_gen, pz_prot_gen, 0.938272)")// const number is mass of proton
-                        .Define("Phi_rec", "proton_rec_4_momentum.Phi()*TMath::RadToDeg()")  
-                        .Define("Phi_gen", "proton_gen_4_momentum.Phi()*TMath::RadToDeg()")
-                        .Define("Theta_rec", "proton_rec_4_momentum.Theta()*TMath::RadToDeg()")
-                        .Define("Theta_gen", "proton_gen_4_momentum.Theta()*TMath::RadToDeg()")
+                        .Define("delta_p", kin::difference, {"p_proton_rec", "p_proton_gen"})
                         //.Define("Theta_proton_DC", "TMath::ATan(sqrt(x1_proton*x1_proton + y1_proton*y1_proton)/z1_proton)*TMath::RadToDeg()")
-                        .Define("detector", [](int status) { 
-                            return status < 4000 ? std::string("FD") : (status < 8000 ? std::string("CD") : std::string("NA")); 
-                        }, {"status_proton"})
-                        .Define("electron_rec_4_momentum", "TLorentzVector(px_electron_rec, py_electron_rec, pz_electron_rec, 0.0)")
-                        .Define("electron_gen_4_momentum", "TLorentzVector(px_electron_gen, py_electron_gen, pz_electron_gen, 0.0)")
-                        .Define("Phi_electron_rec", "electron_rec_4_momentum.Phi()*TMath::RadToDeg()")
-                        .Define("Phi_electron_gen", "electron_gen_4_momentum.Phi()*TMath::RadToDeg()")
-                        .Define("Theta_electron_rec", "electron_rec_4_momentum.Theta()*TMath::RadToDeg()")
-                        .Define("Theta_electron_gen", "electron_gen_4_momentum.Theta()*TMath::RadToDeg()")
-                        .Define("E_proton_rec", "sqrt(px_prot_rec*px_prot_rec + py_prot_rec*py_prot_rec + pz_prot_rec*pz_prot_rec + 0.938272*0.938272)") // const number is mass of proton
-                        .Define("E_proton_gen", "sqrt(px_prot_gen*px_prot_gen + py_prot_gen*py_prot_gen + pz_prot_gen*pz_prot_gen + 0.938272*0.938272)") // const number is mass of proton
-                        .Define("delta_E", "E_proton_rec - E_proton_gen")
-                        .Define("dp_norm", "delta_p /p_proton_rec")
-                        .Define("DC_fiducial_cut_electron", "detector == \"FD\" && edge1_electron > 5.0 && edge2_electron > 5.0 && edge3_electron > 10.0")
-                        .Define("DC_fiducial_cut_proton", "detector == \"FD\" && edge1_proton > 2.5 && edge2_proton > 2.5 && edge3_proton > 9.0");
+                        .Define("delta_E", kin::difference, {"E_proton_rec", "E_proton_gen"})
+                        .Define("dp_norm", kin::ratio, {"delta_p", "p_proton_rec"})
+                        .Define("DC_fiducial_cut_electron", kin::DCFiducial{5.0, 5.0, 10.0},
+                                {"is_FD", "edge1_electron", "edge2_electron", "edge3_electron"})
+                        .Define("DC_fiducial_cut_proton", kin::DCFiducial{2.5, 2.5, 9.0},
+                                {"is_FD", "edge1_proton", "edge2_proton", "edge3_proton"});
                         
 
                 
@@ -135,10 +110,10 @@ int main() {
    //}
      
     //init_rdf.Filter("delta_p == 0").Display()->Print();
-    //init_rdf.Display({"detector", "status_proton", "sector_proton"}, 200)->Print();
+    //init_rdf.Display({"region", "status_proton", "sector_proton"}, 200)->Print();
 
-    //init_rdf.Filter("detector == \"FD\" && sector_proton != 1 && sector_proton != 2 && sector_proton != 3 && sector_proton != 4 && sector_proton != 5 && sector_proton != 6 ").Display({"pid_proton", "status_proton", "detector","sector_proton"}, 100)->Print();
-    //init_rdf.Filter("status_proton > 8000").Display({"pid_proton", "status_proton", "detector","sector_proton"}, 100)->Print();
+    //init_rdf.Filter("is_FD && sector_proton != 1 && sector_proton != 2 && sector_proton != 3 && sector_proton != 4 && sector_proton != 5 && sector_proton != 6 ").Display({"pid_proton", "status_proton", "region","sector_proton"}, 100)->Print();
+    //init_rdf.Filter("status_proton > 8000").Display({"pid_proton", "status_proton", "region","sector_proton"}, 100)->Print();
 
 
     //delta_P_VS_P_rec_FD_unified_1D(init_rdf, OUTPUT_FOLDER, "low", true);
@@ -162,6 +137,8 @@ int main() {
     //Theta_VS_momentum_FD_CD(init_rdf, OUTPUT_FOLDER);
     //plot_P_rec_P_gen(init_rdf, OUTPUT_FOLDER);
 
+    // the plot functions above only book their histograms: fill them all in one event loop, then draw
+    plot_registry().Run();
 
     
     //init_rdf.Display({"p_proton_gen", "p_proton_rec", "delta_p"}, 10)->Print();
@@ -0,0 +1,93 @@
+#!/bin/bash
+# Startup vs event-loop time of the two analysis executables, per git revision.
+# Run from analysis/ with ROOT set up.
+#
+#   ./bench_defines.sh <mc.root> <data.root> [git-rev...]
+#
+# Each revision's analysis/ is built as executable (TTree2RDF.cxx, on <mc.root>)
+# and executable_exp (TTree2RDFExp.cxx, on <data.root>), with RDataFrame info
+# logging forced on, and run BENCH_REPEAT times (default 3). Reported per run,
+# averaged:
+#   jit    time RDataFrame spent JIT-compiling string Defines/Filters, all loops
+#   loop   time inside the event loops
+#   other  rest of main(): opening the input, building the graph, drawing/saving
+#   wall   whole process, including loading the ROOT libraries
+#   rss    peak resident memory of the process, MB (needs GNU time in /usr/bin/time)
+# Default revisions: the last one with string Defines for the physics columns
+# and HEAD (kinematics.cxx). Small quick-look files show the JIT difference
+# best; for the per-event cost of the columns (loop_s, rss_mb), compare e.g.
+# ./bench_defines.sh mc.root data.root <rev with TLorentzVector columns> HEAD
+# on a large file.
+
+MC_INPUT="$1"
+DATA_INPUT="$2"
+OUT_DIR="${BENCH_OUT:-/tmp/analysis_bench}"
+REPEAT="${BENCH_REPEAT:-3}"
+
+if [ ! -f "$MC_INPUT" ] || [ ! -f "$DATA_INPUT" ]; then
+    echo "Usage: $0 <mc.root> <data.root> [git-rev...]"
+    exit 1
+fi
+MC_INPUT="$(readlink -f "$MC_INPUT")"
+DATA_INPUT="$(readlink -f "$DATA_INPUT")"
+shift 2
+REVS=("$@")
+if [ ${#REVS[@]} -eq 0 ]; then
+    added=$(git log --diff-filter=A --format=%h -1 -- kinematics.cxx)
+    REVS=("${added}~1" HEAD)
+fi
+mkdir -p "$OUT_DIR"
+
+# forced include: RDataFrame logs its JIT and event-loop times, for any revision
+cat > "$OUT_DIR/rdf_log.h" << 'EOF'
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RLogger.hxx>
+static ROOT::Experimental::RLogScopedVerbosity bench_rdf_log(ROOT::Detail::RDF::RDFLogChannel(),
+                                                            ROOT::Experimental::ELogLevel::kInfo);
+EOF
+
+# run_one <dir> <exe> <input> <log>  -> prints "<loops> <jit s> <loop s> <main s> <wall s> <rss kB>"
+# The input is also linked where the revision's built-in path points, and its
+# built-in output folder is created, for revisions that take no arguments.
+run_one() {
+    local dir="$1" exe="$2" input="$3" log="$4" src default out t0 t1
+    src=$([ "$exe" = executable ] && echo TTree2RDF.cxx || echo TTree2RDFExp.cxx)
+    default=$(sed -n 's|^std::string root_file_path = "\(.*\)";|\1|p' "$dir/analysis/$src")
+    out=$(sed -n 's|^.*std::string OUTPUT_FOLDER = "\(.*\)" + farm_out.*|\1|p' "$dir/analysis/$src")
+    [ -n "$default" ] && mkdir -p "$(dirname "$dir/analysis/$default")" && ln -sf "$input" "$dir/analysis/$default"
+    [ -n "$out" ] && mkdir -p "$dir/analysis/$out"
+    mkdir -p "$dir/out_$exe"
+    t0=$(date +%s.%N)
+    (cd "$dir/analysis" && "${TIME[@]}" "./$exe" "$input" "$dir/out_$exe/") > "$log" 2>&1
+    t1=$(date +%s.%N)
+    awk -v wall="$(echo "$t1 - $t0" | bc -l)" '
+        /Just-in-time compilation phase completed in [0-9]/ { sub(/.*completed in /, ""); jit += $1 }
+        /Finished event loop number/ { ++loops; sub(/.*CPU, /, ""); loop += $1 }
+        /Time of execution:/ { main = $(NF - 1) }
+        /^max_rss_kb / { rss = $2 }
+        END { printf "%d %.3f %.3f %.3f %.3f %d\n", loops, jit, loop, main, wall, rss }' "$log"
+}
+
+TIME=()
+[ -x /usr/bin/time ] && /usr/bin/time -f "%M" true > /dev/null 2>&1 && TIME=(/usr/bin/time -f "max_rss_kb %M")
+
+printf "%-12s %-15s %6s %8s %8s %8s %8s %8s\n" rev executable loops jit_s loop_s other_s wall_s rss_mb
+for rev in "${REVS[@]}"; do
+    dir="$OUT_DIR/$(git rev-parse --short "$rev")" || exit 1
+    rm -rf "$dir" && mkdir -p "$dir"
+    git archive --prefix=analysis/ "$rev" . | tar -x -C "$dir"
+    for exe in executable executable_exp; do
+        src=$([ "$exe" = executable ] && echo TTree2RDF.cxx || echo TTree2RDFExp.cxx)
+        input=$([ "$exe" = executable ] && echo "$MC_INPUT" || echo "$DATA_INPUT")
+        if ! (cd "$dir/analysis" && g++ $BENCH_CXXFLAGS -include "$OUT_DIR/rdf_log.h" "$src" -o "$exe" \
+                 $(root-config --cflags --glibs)) > "$dir/build_$exe.log" 2>&1; then
+            echo "$rev $exe: build failed, see $dir/build_$exe.log"
+            continue
+        fi
+        for i in $(seq 1 "$REPEAT"); do
+            run_one "$dir" "$exe" "$input" "$dir/run_${exe}_$i.log"
+        done | awk -v rev="$rev" -v exe="$exe" '
+            { loops = $1; jit += $2; loop += $3; other += $4 - $2 - $3; wall += $5; if ($6 > rss) rss = $6; ++n }
+            END { if (n) printf "%-12s %-15s %6d %8.2f %8.2f %8.2f %8.2f %8.0f\n", rev, exe, loops, jit / n, loop / n, other / n, wall / n, rss / 1024 }'
+    done
+done
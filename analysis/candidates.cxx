@@ -0,0 +1,78 @@
+// Candidate selection on a hipo2root --schema=multi dataset; shared by TTree2RDF.cxx and TTree2RDFExp.cxx.
+//
+// The multi schema stores every REC/MC electron and proton of an event as
+// variable-length columns (rec_pid, rec_px, ..., mc_pid, mc_px, ...). Here the
+// proton and electron are picked with RVec operations and exposed under the
+// scalar branch names (px_prot_rec, edge1_electron, ...), so every plot runs
+// unchanged on either schema. Changing how candidates are chosen only means
+// editing this file, not converting the HIPO files again.
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RVec.hxx>
+
+// Position of the first entry of `pid` equal to `wanted`, -1 if there is none.
+int first_with_pid(const ROOT::RVec<int> &pid, int wanted) {
+    const auto idx = ROOT::VecOps::Nonzero(pid == wanted);
+    return idx.empty() ? -1 : static_cast<int>(idx[0]);
+}
+
+// Defines the scalar columns of one picked particle: for every {scalar, array}
+// pair, scalar = array[index_column].
+ROOT::RDF::RNode define_picked(ROOT::RDF::RNode df, const std::string &index_column,
+                               const std::vector<std::pair<std::string, std::string>> &float_columns,
+                               const std::vector<std::pair<std::string, std::string>> &int_columns) {
+    for (const auto &c : float_columns)
+        df = df.Define(c.first, [](const ROOT::RVec<float> &v, int i) { return v[i]; }, {c.second, index_column});
+    for (const auto &c : int_columns)
+        df = df.Define(c.first, [](const ROOT::RVec<int> &v, int i) { return v[i]; }, {c.second, index_column});
+    return df;
+}
+
+// On a multi-schema dataset: pick one proton and one electron per event, the
+// way the scalar schema does, and keep only events that have both. MC picks the
+// first REC (and MC) electron and proton; data requires the trigger electron in
+// REC::Particle row 0. Datasets converted with the scalar schema pass through.
+ROOT::RDF::RNode select_candidates(ROOT::RDF::RNode df, bool is_mc) {
+    const auto columns = df.GetColumnNames();
+    if (std::find(columns.begin(), columns.end(), "rec_pid") == columns.end()) return df;
+
+    auto magnitude = [](float x, float y, float z) { return std::sqrt(x * x + y * y + z * z); };
+
+    df = df.Define("i_proton_rec", [](const ROOT::RVec<int> &pid) { return first_with_pid(pid, 2212); }, {"rec_pid"});
+    if (is_mc) {
+        df = df.Define("i_electron_rec", [](const ROOT::RVec<int> &pid) { return first_with_pid(pid, 11); }, {"rec_pid"});
+    } else {
+        df = df.Define("i_electron_rec", [](const ROOT::RVec<int> &pid, const ROOT::RVec<int> &row) {
+                 return (!pid.empty() && row[0] == 0 && pid[0] == 11) ? 0 : -1;
+             }, {"rec_pid", "rec_index"});
+    }
+    df = df.Filter([](int p, int e) { return p >= 0 && e >= 0; }, {"i_proton_rec", "i_electron_rec"}, "REC e+p");
+
+    df = define_picked(df, "i_proton_rec",
+                       {{"px_prot_rec", "rec_px"}, {"py_prot_rec", "rec_py"}, {"pz_prot_rec", "rec_pz"},
+                        {"vx_prot", "rec_vx"}, {"vy_prot", "rec_vy"}, {"vz_prot", "rec_vz"},
+                        {"edge1_proton", "rec_edge1"}, {"edge2_proton", "rec_edge2"}, {"edge3_proton", "rec_edge3"},
+                        {"x1_proton", "rec_x1"}, {"y1_proton", "rec_y1"}, {"z1_proton", "rec_z1"}},
+                       {{"pid_proton", "rec_pid"}, {"status_proton", "rec_status"}, {"sector_proton", "rec_sector"}});
+    df = define_picked(df, "i_electron_rec",
+                       {{"px_electron_rec", "rec_px"}, {"py_electron_rec", "rec_py"}, {"pz_electron_rec", "rec_pz"},
+                        {"edge1_electron", "rec_edge1"}, {"edge2_electron", "rec_edge2"}, {"edge3_electron", "rec_edge3"},
+                        {"x1_electron", "rec_x1"}, {"y1_electron", "rec_y1"}, {"z1_electron", "rec_z1"}},
+                       {{"pid_electron", "rec_pid"}, {"status_electron", "rec_status"}});
+    df = df.Define("p_proton_rec", magnitude, {"px_prot_rec", "py_prot_rec", "pz_prot_rec"})
+           .Define("p_electron_rec", magnitude, {"px_electron_rec", "py_electron_rec", "pz_electron_rec"});
+
+    if (!is_mc) return df;
+
+    df = df.Define("i_proton_gen", [](const ROOT::RVec<int> &pid) { return first_with_pid(pid, 2212); }, {"mc_pid"})
+           .Define("i_electron_gen", [](const ROOT::RVec<int> &pid) { return first_with_pid(pid, 11); }, {"mc_pid"})
+           .Filter([](int p, int e) { return p >= 0 && e >= 0; }, {"i_proton_gen", "i_electron_gen"}, "MC e+p");
+    df = define_picked(df, "i_proton_gen", {{"px_prot_gen", "mc_px"}, {"py_prot_gen", "mc_py"}, {"pz_prot_gen", "mc_pz"}}, {});
+    df = define_picked(df, "i_electron_gen", {{"px_electron_gen", "mc_px"}, {"py_electron_gen", "mc_py"}, {"pz_electron_gen", "mc_pz"}}, {});
+    return df.Define("p_proton_gen", magnitude, {"px_prot_gen", "py_prot_gen", "pz_prot_gen"})
+             .Define("p_electron_gen", magnitude, {"px_electron_gen", "py_electron_gen", "pz_electron_gen"});
+}
@@ -0,0 +1,238 @@
+// Opening converter output as an RDataFrame; shared by TTree2RDF.cxx and TTree2RDFExp.cxx.
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <set>
+#include <string>
+#include <vector>
+#include <glob.h>
+#include <TChain.h>
+#include <TFile.h>
+#include <TKey.h>
+#include <TSystem.h>
+#include <RVersion.h>
+#include <ROOT/RDataFrame.hxx>
+#if ROOT_VERSION_CODE < ROOT_VERSION(6, 34, 0)
+#include <ROOT/RNTupleDS.hxx>
+#endif
+#ifdef H2R_WITH_HIPO
+// HIPO file lists are read directly, without hipo2root. Build with
+//   -DH2R_WITH_HIPO -I../utils/hipo2root plus the clas12root/hipo4 include and library flags
+#include "hipo_datasource.h"
+#endif
+
+// Shard files listed in <dir>/manifest.tsv of a sharded hipo2root run (--shard-dir).
+std::vector<std::string> shard_files_from_manifest(const std::string &dir) {
+    std::vector<std::string> files;
+    std::set<std::string> seen;
+    std::ifstream manifest(dir + "/manifest.tsv");
+    for (std::string line; std::getline(manifest, line);) {
+        if (line.empty() || line[0] == '#') continue;
+        const std::string shard = line.substr(line.rfind('\t') + 1);
+        if (seen.insert(shard).second) files.push_back(dir + "/" + shard);
+    }
+    return files;
+}
+
+bool has_suffix(const std::string &s, const std::string &suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// ROOT files named by one input, in order:
+//   a,b,...    each part expanded on its own
+//   dir/       the shards of its manifest.tsv, or else every *.root in it, sorted
+//   *.list     one input per line ('#' comments), each expanded on its own
+//   glob       the matching paths, sorted (a pattern matching nothing is an error)
+//   anything else, including root:// URLs, is taken as one file.
+std::vector<std::string> expand_root_inputs(const std::string &input) {
+    std::vector<std::string> files;
+    const auto append = [&](const std::vector<std::string> &more) { files.insert(files.end(), more.begin(), more.end()); };
+
+    if (input.find(',') != std::string::npos) {
+        std::stringstream parts(input);
+        for (std::string part; std::getline(parts, part, ',');)
+            if (!part.empty()) append(expand_root_inputs(part));
+        return files;
+    }
+
+    Long_t id, flags, modtime; Long64_t size;
+    const bool is_dir = gSystem->GetPathInfo(input.c_str(), &id, &size, &flags, &modtime) == 0 && (flags & 2);
+    if (is_dir) {
+        files = shard_files_from_manifest(input);
+        if (!files.empty()) {
+            std::cout << "Reading " << files.size() << " shards from " << input << std::endl;
+            return files;
+        }
+        if (void *dir = gSystem->OpenDirectory(input.c_str())) {
+            while (const char *entry = gSystem->GetDirEntry(dir))
+                if (has_suffix(entry, ".root")) files.push_back(input + "/" + entry);
+            gSystem->FreeDirectory(dir);
+        }
+        std::sort(files.begin(), files.end());
+        if (files.empty()) std::cerr << "Error: no manifest.tsv and no .root files in " << input << std::endl;
+        return files;
+    }
+
+    if (has_suffix(input, ".list")) {
+        std::ifstream list(input);
+        if (!list) std::cerr << "Error: cannot read file list " << input << std::endl;
+        for (std::string line; std::getline(list, line);) {
+            line.erase(0, line.find_first_not_of(" \t"));
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line[0] != '#') append(expand_root_inputs(line));
+        }
+        return files;
+    }
+
+    if (input.find_first_of("*?[") != std::string::npos && input.find("://") == std::string::npos) {
+        glob_t matches;
+        if (glob(input.c_str(), 0, nullptr, &matches) == 0)
+            for (size_t i = 0; i < matches.gl_pathc; ++i) files.push_back(matches.gl_pathv[i]);
+        globfree(&matches);
+        if (files.empty()) std::cerr << "Error: no files match " << input << std::endl;
+        return files;
+    }
+
+    files.push_back(input);
+    return files;
+}
+
+// Name of the first TTree or RNTuple in `file`, "" if it has none or cannot be opened.
+std::string find_tree_name(const std::string &file, bool &is_rntuple) {
+    std::unique_ptr<TFile> f(TFile::Open(file.c_str(), "READ"));
+    if (!f || f->IsZombie()) {
+        std::cerr << "Error: Cannot open ROOT file " << file << std::endl;
+        return "";
+    }
+    TIter next(f->GetListOfKeys());
+    while (TKey *key = (TKey *)next()) {
+        const std::string class_name = key->GetClassName();
+        if (class_name == "TTree" || class_name.find("RNTuple") != std::string::npos) {
+            is_rntuple = class_name != "TTree";
+            return key->GetName();
+        }
+    }
+    std::cerr << "No TTrees or RNTuples found in " << file << std::endl;
+    return "";
+}
+
+// Extra columns for the same events, in the same order and with the same number
+// of entries as the main files: e.g. a derived-column file written from them.
+// `path` is expanded like the main input; the columns are read as <alias>.<column>,
+// or under their own names when `alias` is empty. An empty `tree_name` is looked
+// up in the first friend file.
+struct FriendFiles {
+    std::string path;
+    std::string tree_name;
+    std::string alias;
+};
+
+// "[alias=]path", as the analysis executables take friends on the command line.
+// The alias is used in column names, so it has to be a C++ identifier; otherwise
+// the whole argument is the path (e.g. "sp2019-v2=out.root" or "../a=b/out.root").
+FriendFiles friend_from_arg(const std::string &arg) {
+    const auto eq = arg.find('=');
+    const auto is_alias = [](const std::string &s) {
+        if (s.empty() || !(std::isalpha(static_cast<unsigned char>(s[0])) || s[0] == '_')) return false;
+        return std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isalnum(c) || c == '_'; });
+    };
+    if (eq == std::string::npos || !is_alias(arg.substr(0, eq))) return {arg, "", ""};
+    return {arg.substr(eq + 1), "", arg.substr(0, eq)};
+}
+
+// TChains read by the frames made with friends: RDataFrame(TTree&) does not own them.
+std::vector<std::unique_ptr<TChain>> &dataset_chains() {
+    static std::vector<std::unique_ptr<TChain>> chains;
+    return chains;
+}
+
+// One RDataFrame over every file of `inputs` (see expand_root_inputs), read as a
+// single dataset. Under ImplicitMT RDataFrame splits the work at the TTree
+// cluster boundaries of each file, so shards and re-conversions are processed in
+// parallel like one big file. `tree_name` skips opening the first file to find
+// the tree; before ROOT 6.34 a name given this way is read as a TTree.
+// With friends the files are chained (TChain::AddFriend) and the frame reads the
+// chain; friends need TTree inputs.
+ROOT::RDataFrame open_root_dataset(const std::vector<std::string> &inputs, const std::string &tree_name = "",
+                                   const std::vector<FriendFiles> &friends = {}) {
+    std::vector<std::string> files;
+    for (const auto &input : inputs) {
+        const auto expanded = expand_root_inputs(input);
+        files.insert(files.end(), expanded.begin(), expanded.end());
+    }
+    if (files.empty()) {
+        std::cerr << "Error: no input ROOT files" << std::endl;
+        return ROOT::RDataFrame(0);
+    }
+    if (files.size() > 1) std::cout << "Reading " << files.size() << " ROOT files as one dataset" << std::endl;
+
+    std::string name = tree_name;
+    bool is_rntuple = false;
+    if (name.empty()) {
+        name = find_tree_name(files.front(), is_rntuple);
+        if (name.empty()) return ROOT::RDataFrame(0);
+    }
+
+    if (is_rntuple) {
+        std::cout << "Processing RNTuple: " << name << std::endl;
+        if (!friends.empty()) std::cerr << "Warning: friends are only read with TTree inputs, ignored" << std::endl;
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 34, 0)
+        // the RDataFrame constructor recognises RNTuples by itself from 6.34 on
+        return ROOT::RDataFrame(name, files);
+#else
+        if (files.size() > 1) {
+            std::cerr << "Warning: this ROOT version reads a single RNTuple file, only " << files.front() << " is used" << std::endl;
+        }
+        return ROOT::RDF::Experimental::FromRNTuple(name, files.front());
+#endif
+    }
+
+    std::cout << "Processing TTree: " << name << std::endl;
+    if (friends.empty()) return ROOT::RDataFrame(name, files);
+
+    auto chain = std::make_unique<TChain>(name.c_str());
+    for (const auto &file : files) chain->Add(file.c_str());
+    for (const auto &fr : friends) {
+        const auto friend_files = expand_root_inputs(fr.path);
+        if (friend_files.empty()) return ROOT::RDataFrame(0);
+        std::string friend_name = fr.tree_name;
+        bool friend_is_rntuple = false;
+        if (friend_name.empty()) friend_name = find_tree_name(friend_files.front(), friend_is_rntuple);
+        if (friend_name.empty() || friend_is_rntuple) {
+            std::cerr << "Error: friend " << fr.path << " has no TTree" << std::endl;
+            return ROOT::RDataFrame(0);
+        }
+        auto friend_chain = std::make_unique<TChain>(friend_name.c_str());
+        for (const auto &file : friend_files) friend_chain->Add(file.c_str());
+        chain->AddFriend(friend_chain.get(), fr.alias.c_str());
+        std::cout << "Friend TTree: " << friend_name << " from " << friend_files.size() << " file(s)"
+                  << (fr.alias.empty() ? "" : ", as " + fr.alias + ".*") << std::endl;
+        dataset_chains().push_back(std::move(friend_chain));
+    }
+    dataset_chains().push_back(std::move(chain));
+    return ROOT::RDataFrame(*dataset_chains().back());
+}
+
+// `root_file_path` is anything open_root_dataset() takes as one input: a ROOT file,
+// a glob, a shard or plain directory, a .list file or a comma-separated list; all
+// files are read as one dataset. Converter output may be a TTree or an RNTuple
+// (--format=rntuple). A .dat/.txt HIPO file list is read event by event through
+// h2r::HipoDataSource, with the columns hipo2root would write for MC (`hipo_is_mc`)
+// or data; this needs -DH2R_WITH_HIPO.
+ROOT::RDataFrame convert_ttrees_to_rdataframe(const std::string &root_file_path, bool hipo_is_mc = true,
+                                              const std::string &tree_name = "",
+                                              const std::vector<FriendFiles> &friends = {}) {
+    if (has_suffix(root_file_path, ".dat") || has_suffix(root_file_path, ".txt")) {
+#ifdef H2R_WITH_HIPO
+        std::cout << "Reading HIPO files listed in " << root_file_path << std::endl;
+        return h2r::MakeHipoDataFrame(root_file_path, hipo_is_mc);
+#else
+        std::cerr << "Error: " << root_file_path << " is a HIPO file list; rebuild with -DH2R_WITH_HIPO to read it directly" << std::endl;
+        return ROOT::RDataFrame(0);
+#endif
+    }
+    return open_root_dataset({root_file_path}, tree_name, friends);
+}
@@ -0,0 +1,142 @@
+// Physics columns of the analysis as compiled kernels; shared by TTree2RDF.cxx and TTree2RDFExp.cxx.
+//
+// init_rdf used to be built from string Defines, each JIT-compiled by cling
+// when the first event loop starts; on small quick-look files that was most of
+// the run. These are plain typed functions passed to Define() instead, so the
+// compiler inlines them and nothing is left to JIT for the column set-up.
+//
+// Four-momenta are FourVector, four floats, instead of TLorentzVector (a
+// TObject holding a TVector3, 64 bytes and two constructors per value).
+// event_kinematics() derives everything an event needs from the electron and
+// proton in one call: angles, energies and the inclusive Q2, nu, W, xB.
+// Angles follow TVector3::Phi()/Theta() (0 for a null vector), in degrees.
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <ROOT/RDataFrame.hxx>
+#include <TMath.h>
+#include "../utils/hipo2root/region.h"
+
+namespace kin {
+
+constexpr double kProtonMass   = 0.938272;
+constexpr double kElectronMass = 0.000511;
+constexpr double kBeamEnergy   = 10.6;     // electron beam along z
+
+inline double phi_deg(float px, float py) {
+    const double x = px, y = py;
+    return (x == 0.0 && y == 0.0 ? 0.0 : std::atan2(y, x)) * TMath::RadToDeg();
+}
+
+inline double theta_deg(float px, float py, float pz) {
+    const double x = px, y = py, z = pz;
+    return (x == 0.0 && y == 0.0 && z == 0.0 ? 0.0 : std::atan2(std::sqrt(x * x + y * y), z)) * TMath::RadToDeg();
+}
+
+inline double energy(float px, float py, float pz, double mass) {
+    return std::sqrt(px * px + py * py + pz * pz + mass * mass);
+}
+
+struct FourVector {
+    float px, py, pz, e;
+
+    double P2() const { return double(px) * px + double(py) * py + double(pz) * pz; }
+    double P() const { return std::sqrt(P2()); }
+    double M2() const { return double(e) * e - P2(); }
+    double M() const { const double m2 = M2(); return m2 < 0 ? -std::sqrt(-m2) : std::sqrt(m2); }   // as TLorentzVector
+    double ThetaDeg() const { return theta_deg(px, py, pz); }
+    double PhiDeg() const { return phi_deg(px, py); }
+};
+static_assert(sizeof(FourVector) == 16 && std::is_trivially_copyable<FourVector>::value,
+              "FourVector is meant to be a plain 16-byte value");
+
+inline FourVector four_vector(float px, float py, float pz, double mass) {
+    return {px, py, pz, static_cast<float>(energy(px, py, pz, mass))};
+}
+
+inline FourVector proton_p4(float px, float py, float pz) { return four_vector(px, py, pz, kProtonMass); }
+inline FourVector electron_p4(float px, float py, float pz) { return four_vector(px, py, pz, kElectronMass); }
+
+// Per-event kinematics of the e+p pair, scattered electron against the beam
+// (0, 0, kBeamEnergy, kBeamEnergy) and a proton target at rest.
+struct EventKinematics {
+    float theta_e, phi_e, e_e;     // electron: degrees, GeV
+    float theta_p, phi_p, e_p;     // proton
+    float q2, nu, w, xb;
+};
+
+inline EventKinematics event_kinematics(const FourVector &el, const FourVector &pr) {
+    EventKinematics k;
+    k.theta_e = el.ThetaDeg();  k.phi_e = el.PhiDeg();  k.e_e = el.e;
+    k.theta_p = pr.ThetaDeg();  k.phi_p = pr.PhiDeg();  k.e_p = pr.e;
+    // q = beam - electron; in double, Q2 is a small difference of large terms
+    const double qx = -el.px, qy = -el.py, qz = kBeamEnergy - el.pz, nu = kBeamEnergy - el.e;
+    const double q2 = -(nu * nu - (qx * qx + qy * qy + qz * qz));
+    const double w2 = kProtonMass * kProtonMass + 2 * kProtonMass * nu - q2;
+    k.q2 = q2;
+    k.nu = nu;
+    k.w  = w2 < 0 ? -std::sqrt(-w2) : std::sqrt(w2);
+    k.xb = q2 / (2 * kProtonMass * nu);
+    return k;
+}
+
+// Scalar columns from the members of a struct column: for every {name, member}
+// pair, name = from.*member.
+template <typename T>
+ROOT::RDF::RNode define_members(ROOT::RDF::RNode df, const std::string &from,
+                                const std::vector<std::pair<std::string, float T::*>> &members) {
+    for (const auto &m : members) {
+        const auto member = m.second;
+        df = df.Define(m.first, [member](const T &k) { return k.*member; }, {from});
+    }
+    return df;
+}
+
+// The kinematics of one level ("rec" or "gen"), from px_prot_<level>, ... and
+// px_electron_<level>, ...: proton_/electron_<level>_4_momentum, kin_<level>,
+// Theta_/Phi_/E_proton_<level>, Theta_/Phi_electron_<level> and Q2, nu, W, xB
+// (rec) or Q2_gen, nu_gen, W_gen, xB_gen.
+inline ROOT::RDF::RNode define_kinematics(ROOT::RDF::RNode df, const std::string &level) {
+    const std::string s = "_" + level, inclusive = level == "rec" ? "" : s;
+    df = df.Define("proton" + s + "_4_momentum", proton_p4, {"px_prot" + s, "py_prot" + s, "pz_prot" + s})
+           .Define("electron" + s + "_4_momentum", electron_p4, {"px_electron" + s, "py_electron" + s, "pz_electron" + s})
+           .Define("kin" + s, event_kinematics, {"electron" + s + "_4_momentum", "proton" + s + "_4_momentum"});
+    return define_members<EventKinematics>(df, "kin" + s,
+        {{"Theta" + s, &EventKinematics::theta_p}, {"Phi" + s, &EventKinematics::phi_p},
+         {"E_proton" + s, &EventKinematics::e_p},
+         {"Theta_electron" + s, &EventKinematics::theta_e}, {"Phi_electron" + s, &EventKinematics::phi_e},
+         {"Q2" + inclusive, &EventKinematics::q2}, {"nu" + inclusive, &EventKinematics::nu},
+         {"W" + inclusive, &EventKinematics::w}, {"xB" + inclusive, &EventKinematics::xb}});
+}
+
+inline float difference(float rec, float gen) { return rec - gen; }
+inline float ratio(float num, float den) { return num / den; }
+
+// Detector region of the proton: region (std::uint8_t, h2r::Region) and the
+// booleans is_FD / is_CD that plot filters test. Read from the converter's
+// region_proton column when the input has one, else derived from status_proton.
+inline ROOT::RDF::RNode define_region(ROOT::RDF::RNode df) {
+    const auto columns = df.GetColumnNames();
+    if (std::find(columns.begin(), columns.end(), "region_proton") != columns.end())
+        df = df.Define("region", [](int region) { return static_cast<std::uint8_t>(region); }, {"region_proton"});
+    else
+        df = df.Define("region", [](int status) { return static_cast<std::uint8_t>(h2r::regionOf(status)); }, {"status_proton"});
+    return df.Define("is_FD", [](std::uint8_t region) { return region == h2r::kRegionFD; }, {"region"})
+             .Define("is_CD", [](std::uint8_t region) { return region == h2r::kRegionCD; }, {"region"});
+}
+
+// DC fiducial cut: forward detector and all three region edges above their
+// thresholds (cm). Used as Define("...", kin::DCFiducial{5.0, 5.0, 10.0}, {"is_FD", ...}).
+struct DCFiducial {
+    double edge1, edge2, edge3;
+    bool operator()(bool is_fd, float e1, float e2, float e3) const {
+        return is_fd && e1 > edge1 && e2 > edge2 && e3 > edge3;
+    }
+};
+
+} // namespace kin
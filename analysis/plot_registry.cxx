@@ -0,0 +1,61 @@
+// Plots booked first, drawn after one event loop; shared by plots.cxx and TTree2RDFExp.cxx.
+//
+// RDataFrame results are lazy: a Histo1D/2D/3D is filled the first time one of
+// them is dereferenced, together with everything booked on the dataframe so
+// far. A plot function that books and draws straight away therefore starts an
+// event loop of its own, one full pass over the dataset per function. Plot
+// functions instead book their results and hand the drawing over:
+//     auto hist = rdf.Histo1D(...);
+//     plot_registry().Book({hist}, [=]() mutable { TCanvas canvas(...); hist->Draw(); canvas.SaveAs(...); });
+// (mutable: RResultPtr::operator-> is non-const) and main() calls
+// plot_registry().Run() once, after the last plot function: every booked
+// result is filled in a single event loop (ROOT::RDF::RunGraphs), then the
+// drawing callbacks run in booking order. Dereferencing a result before Run()
+// still works, but costs an event loop of its own again.
+#pragma once
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RDFHelpers.hxx>
+#include <ROOT/RResultHandle.hxx>
+
+class PlotRegistry {
+public:
+    // `results` are filled by the next Run(), which then calls `render`; with no
+    // results, `render` just runs in its place among the others.
+    void Book(std::vector<ROOT::RDF::RResultHandle> results, std::function<void()> render) {
+        results_.insert(results_.end(), results.begin(), results.end());
+        renders_.push_back(std::move(render));
+    }
+
+    // Fills all booked results in one event loop, then draws them; the
+    // registry is empty afterwards and can be booked into again.
+    void Run() {
+        if (renders_.empty()) return;
+        auto results = std::move(results_);
+        auto renders = std::move(renders_);
+        results_.clear();
+        renders_.clear();
+
+        const auto start = std::chrono::steady_clock::now();
+        if (!results.empty()) ROOT::RDF::RunGraphs(results);
+        const std::chrono::duration<double> filled = std::chrono::steady_clock::now() - start;
+        std::cout << "[plots] " << results.size() << " results of " << renders.size()
+                  << " plots filled in " << filled.count() << " s" << std::endl;
+
+        for (auto &render : renders) render();
+    }
+
+private:
+    std::vector<ROOT::RDF::RResultHandle> results_;
+    std::vector<std::function<void()>> renders_;
+};
+
+// The registry plot functions book into.
+inline PlotRegistry &plot_registry() {
+    static PlotRegistry registry;
+    return registry;
+}
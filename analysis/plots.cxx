@@ -11,89 +11,71 @@
 #include "TFile.h"
 #include "THnSparse.h"  // Needed for THnSparseD
 #include "TArrayD.h"
+#include <cstdlib>
 #include <string>
 #include <TText.h>
 #include <TPaveText.h>  // add at top of file if not already included
 #include <TLatex.h>
 
 #include "TLorentzVector.h"
+#include "plot_registry.cxx"
+
+// Every plot function books its histograms and leaves the drawing to the plot
+// registry: nothing is filled or saved until main() calls plot_registry().Run().
 
 
 //---------------------------------------------------------W, Q2---------------------------------
-// Compute W and Q^2 from existing 4-vectors and save PDFs.
+// Plot W and Q^2 of the reconstructed electron and save PDFs.
 // e_initial = (10.6, 0, 0, 10.6), target at rest (0,0,0,Mp).
-// Uses: electron_rec_4_momentum (TLorentzVector) already defined in init_rdf.
+// Uses: Q2 and W, defined in init_rdf by kin::define_kinematics (kinematics.cxx).
 void plot_W_Q2_rec_from4v(ROOT::RDF::RNode rdf, const std::string& output_folder) {
-    const double Ebeam = 10.6;
-    const double Mp    = 0.938272;
-
-    auto df = rdf
-        // Q^2 = -q^2, with q = e_initial - e_final(rec)
-        .Define("Q2_rec",
-                [Ebeam](const TLorentzVector& e_rec_in) {
-                    TLorentzVector e_f = e_rec_in;
-                    if (e_f.E() == 0.0) e_f.SetE(e_f.P());  // treat as massless if E was set 0
-                    TLorentzVector e_i(0.0, 0.0, Ebeam, Ebeam);
-                    TLorentzVector q = e_i - e_f;
-                    return -q.M2();
-                },
-                {"electron_rec_4_momentum"})
-        // W = sqrt((p_target + q)^2), p_target = (0,0,0,Mp)
-        .Define("W_rec",
-                [Ebeam, Mp](const TLorentzVector& e_rec_in) {
-                    TLorentzVector e_f = e_rec_in;
-                    if (e_f.E() == 0.0) e_f.SetE(e_f.P());
-                    TLorentzVector e_i(0.0, 0.0, Ebeam, Ebeam);
-                    TLorentzVector q = e_i - e_f;
-                    TLorentzVector p_target(0.0, 0.0, 0.0, Mp);
-                    return (p_target + q).M();
-                },
-                {"electron_rec_4_momentum"});
-
-
-
-    // 1) W distribution
-    {
-        TCanvas cW("cW_rec4v","W distribution",800,600);
-        auto hW = df.Histo1D(
-            ROOT::RDF::TH1DModel("hW_rec4v","W distribution;W (GeV);Counts",
-                                 100, 1, 5),
-            "W_rec");
-        hW->SetLineWidth(2);
-        hW->Draw("HIST");
-        cW.SaveAs((output_folder + "W_rec4v.pdf").c_str());
-    }
+    auto df = rdf.Alias("Q2_rec", "Q2").Alias("W_rec", "W");
+
+    auto hW = df.Histo1D(
+        ROOT::RDF::TH1DModel("hW_rec4v","W distribution;W (GeV);Counts",
+                             100, 1, 5),
+        "W_rec");
+    auto hQ2 = df.Histo1D(
+        ROOT::RDF::TH1DModel("hQ2_rec4v","Q^{2} distribution;Q^{2} (GeV^{2});Counts",
+                             100, 0, 11),
+        "Q2_rec");
+    auto h2 = df.Histo2D(
+        ROOT::RDF::TH2DModel("hWvsQ2_rec4v",
+                             "Q^{2} vs W; W (GeV); Q^{2} (GeV^{2})",
+                             100, 0, 5,
+                             100, 1 , 11),
+        "W_rec", "Q2_rec");
+
+    plot_registry().Book({hW, hQ2, h2}, [=]() mutable {
+        // 1) W distribution
+        {
+            TCanvas cW("cW_rec4v","W distribution",800,600);
+            hW->SetLineWidth(2);
+            hW->Draw("HIST");
+            cW.SaveAs((output_folder + "W_rec4v.pdf").c_str());
+        }
 
-    // 2) Q^2 distribution
-    {
-        TCanvas cQ2("cQ2_rec4v","Q^{2} distribution",800,600);
-        auto hQ2 = df.Histo1D(
-            ROOT::RDF::TH1DModel("hQ2_rec4v","Q^{2} distribution;Q^{2} (GeV^{2});Counts",
-                                 100, 0, 11),
-            "Q2_rec");
-        hQ2->SetLineWidth(2);
-        hQ2->Draw("HIST");
-        cQ2.SaveAs((output_folder + "Q2_rec4v.pdf").c_str());
-    }
+        // 2) Q^2 distribution
+        {
+            TCanvas cQ2("cQ2_rec4v","Q^{2} distribution",800,600);
+            hQ2->SetLineWidth(2);
+            hQ2->Draw("HIST");
+            cQ2.SaveAs((output_folder + "Q2_rec4v.pdf").c_str());
+        }
 
-    // 3) 2D W vs Q^2 (X=Q^2, Y=W)
-    {
-        TCanvas c2D("cWQ2_rec4v","W vs Q^{2}",900,700);
-        c2D.SetRightMargin(0.15);
-        auto h2 = df.Histo2D(
-            ROOT::RDF::TH2DModel("hWvsQ2_rec4v",
-                                 "Q^{2} vs W; W (GeV); Q^{2} (GeV^{2})",
-                                 100, 0, 5,
-                                 100, 1 , 11),
-            "W_rec", "Q2_rec");
-        h2->Draw("COLZ");
-        c2D.SaveAs((output_folder + "W_vs_Q2_rec4v.pdf").c_str());
-    }
+        // 3) 2D W vs Q^2 (X=Q^2, Y=W)
+        {
+            TCanvas c2D("cWQ2_rec4v","W vs Q^{2}",900,700);
+            c2D.SetRightMargin(0.15);
+            h2->Draw("COLZ");
+            c2D.SaveAs((output_folder + "W_vs_Q2_rec4v.pdf").c_str());
+        }
 
-    std::cout << "[plot_W_Q2_rec_from4v] Saved: "
-              << output_folder << "W_rec4v.pdf, "
-              << output_folder << "Q2_rec4v.pdf, "
-              << output_folder << "W_vs_Q2_rec4v.pdf" << std::endl;
+        std::cout << "[plot_W_Q2_rec_from4v] Saved: "
+                  << output_folder << "W_rec4v.pdf, "
+                  << output_folder << "Q2_rec4v.pdf, "
+                  << output_folder << "W_vs_Q2_rec4v.pdf" << std::endl;
+    });
 }
 
 //----------------------------------------------------------------------------------------------------------
@@ -102,166 +84,189 @@ void plot_W_Q2_rec_from4v(ROOT::RDF::RNode rdf, const std::string& output_folder
 
 
 void plot_delta_P(ROOT::RDF::RNode rdf,const std::string& output_folder) {
-    TCanvas canvas("c1", "delta_P", 800, 600);
     auto hist = rdf.Histo1D(ROOT::RDF::TH1DModel("delta_P", "delta_P (rec - gen); delta P (GeV); Events", 100, -0.5, 0.5), "delta_p");
-    hist->Draw();
-    canvas.SaveAs((output_folder + "delta_P.pdf").c_str());
-    std::cout << "Saved 1D histogram as delta_P.pdf" << std::endl;
+    plot_registry().Book({hist}, [=]() mutable {
+        TCanvas canvas("c1", "delta_P", 800, 600);
+        hist->Draw();
+        canvas.SaveAs((output_folder + "delta_P.pdf").c_str());
+        std::cout << "Saved 1D histogram as delta_P.pdf" << std::endl;
+    });
 }
 
 void plot_momenta_components(ROOT::RDF::RNode rdf, const std::string& output_folder) { // do not use loops, the graphs are too different for slicing and loopiong will lead to lazy eval
-    TCanvas canvas("c2", "momenta_components", 800, 600);
-    canvas.Divide(3,2);
-    canvas.cd(1);
     auto hist1 = rdf.Histo1D(ROOT::RDF::TH1DModel("px_proton_gen", "px_proton_gen; px_proton_gen (GeV); Events", 100, -2, 2), "px_prot_gen");
-    hist1->Draw();
-    canvas.cd(2);
     auto hist2 = rdf.Histo1D(ROOT::RDF::TH1DModel("py_proton_gen", "py_proton_gen; py_proton_gen (GeV); Events", 100, -2, 2), "py_prot_gen");
-    hist2->Draw();
-    canvas.cd(3);   
     auto hist3 = rdf.Histo1D(ROOT::RDF::TH1DModel("pz_proton_gen", "pz_proton_gen; pz_proton_gen (GeV); Events", 100, 0, 8), "pz_prot_gen");
-    hist3->Draw();
-    canvas.cd(4);
     auto hist4 = rdf.Histo1D(ROOT::RDF::TH1DModel("px_proton_rec", "px_proton_rec; px_proton_rec (GeV); Events", 100, -2, 2), "px_prot_rec");
-    hist4->Draw();
-    canvas.cd(5);
     auto hist5 = rdf.Histo1D(ROOT::RDF::TH1DModel("py_proton_rec", "py_proton_rec; py_proton_rec (GeV); Events", 100, -2, 2), "py_prot_rec");
-    hist5->Draw();
-    canvas.cd(6);
     auto hist6 = rdf.Histo1D(ROOT::RDF::TH1DModel("pz_proton_rec", "pz_proton_rec; pz_proton_rec (GeV); Events", 100, 0, 3), "pz_prot_rec");
-    hist6->Draw();
 
-    canvas.SaveAs((output_folder + "momenta_components.pdf").c_str());
-    std::cout << "Saved 1D histogram as momenta_components.pdf" << std::endl;
+    plot_registry().Book({hist1, hist2, hist3, hist4, hist5, hist6}, [=]() mutable {
+        TCanvas canvas("c2", "momenta_components", 800, 600);
+        canvas.Divide(3,2);
+        canvas.cd(1);
+        hist1->Draw();
+        canvas.cd(2);
+        hist2->Draw();
+        canvas.cd(3);
+        hist3->Draw();
+        canvas.cd(4);
+        hist4->Draw();
+        canvas.cd(5);
+        hist5->Draw();
+        canvas.cd(6);
+        hist6->Draw();
+
+        canvas.SaveAs((output_folder + "momenta_components.pdf").c_str());
+        std::cout << "Saved 1D histogram as momenta_components.pdf" << std::endl;
+    });
 }
 
 
 void plot_delta_P_VS_P_rec(ROOT::RDF::RNode rdf, const std::string& output_folder) {
-    rdf = rdf.Filter("detector == \"FD\" && DC_fiducial_cut_electron == true && DC_fiducial_cut_proton == true "); 
+    rdf = rdf.Filter("is_FD && DC_fiducial_cut_electron == true && DC_fiducial_cut_proton == true ");
     //rdf = rdf.Filter("Theta_rec < 27");
-    TCanvas canvas("c5", "delta P VS P_rec", 800, 600);
     auto hist2D = rdf.Histo2D(ROOT::RDF::TH2DModel("delta_P_VS_P_rec", "delta P vs P_rec;  P_rec (GeV); delta P (GeV)", 200, 0, 6, 200, -0.1, 0.1), "p_proton_rec", "delta_p");
-    hist2D->Draw("COLZ");
-    canvas.SaveAs((output_folder + "delta_P_VS_P_rec_FD.pdf").c_str());
-    std::cout << "Saved 2D histogram as delta_P_VS_P_rec_FD.pdf" << std::endl;
+    plot_registry().Book({hist2D}, [=]() mutable {
+        TCanvas canvas("c5", "delta P VS P_rec", 800, 600);
+        hist2D->Draw("COLZ");
+        canvas.SaveAs((output_folder + "delta_P_VS_P_rec_FD.pdf").c_str());
+        std::cout << "Saved 2D histogram as delta_P_VS_P_rec_FD.pdf" << std::endl;
+    });
 }
 
 
 
 
 void plot_delta_P_VS_P_rec_FD_Theta_below_above(ROOT::RDF::RNode rdf, const std::string& output_folder){
-    auto rdf_above = rdf.Filter("(Theta_rec > 33) && detector == \"FD\" ");
-    auto rdf_below = rdf.Filter("(Theta_rec < 27) && detector == \"FD\" ");
-    TCanvas canvas("c1", "delta_P", 800, 600);
-    canvas.Divide(1,2);
-    canvas.cd(1);
+    auto rdf_above = rdf.Filter("(Theta_rec > 33) && is_FD ");
+    auto rdf_below = rdf.Filter("(Theta_rec < 27) && is_FD ");
     auto hist2D_above = rdf_above.Histo2D(ROOT::RDF::TH2DModel("delta_P_VS_P_rec_above_Theta", "delta P vs P_rec for theta > 33 deg;  P_rec (GeV); delta P (GeV)", 100, 0, 5, 100, -0.1, 0.1), "p_proton_rec", "delta_p");
-    hist2D_above->Draw("COLZ");
-    canvas.cd(2);
     auto hist2D_below = rdf_below.Histo2D(ROOT::RDF::TH2DModel("delta_P_VS_P_rec_below_Theta", "delta P vs P_rec for theta < 27 deg;  P_rec (GeV); delta P (GeV)", 100, 0, 5, 100, -0.1, 0.1), "p_proton_rec", "delta_p");
-    hist2D_below->Draw("COLZ");
-    canvas.SaveAs((output_folder + "delta_P_VS_P_rec_FD_Theta_high_low.pdf").c_str());
-    std::cout << "Saved 1D histogram as delta_P_VS_P_rec_FD_Theta_high_low.pdf" << std::endl;
+    plot_registry().Book({hist2D_above, hist2D_below}, [=]() mutable {
+        TCanvas canvas("c1", "delta_P", 800, 600);
+        canvas.Divide(1,2);
+        canvas.cd(1);
+        hist2D_above->Draw("COLZ");
+        canvas.cd(2);
+        hist2D_below->Draw("COLZ");
+        canvas.SaveAs((output_folder + "delta_P_VS_P_rec_FD_Theta_high_low.pdf").c_str());
+        std::cout << "Saved 1D histogram as delta_P_VS_P_rec_FD_Theta_high_low.pdf" << std::endl;
+    });
 }
 
 void plot_P_rec_P_gen(ROOT::RDF::RNode rdf, const std::string& output_folder) {
-    TCanvas canvas("c6", "P_rec VS P_gen", 800, 600);
-    canvas.Divide(1,2);
-    canvas.cd(1);
     auto hist1 = rdf.Histo1D(ROOT::RDF::TH1DModel("p_proton_gen", "p_proton_gen; p_proton_gen (GeV); Events", 100, 0, 5), "p_proton_gen");
-    hist1->Draw();
-    canvas.cd(2);
     auto hist2 = rdf.Histo1D(ROOT::RDF::TH1DModel("p_proton_rec", "p_proton_rec; p_proton_rec (GeV); Events", 100, 0, 5), "p_proton_rec");
-    hist2->Draw();
-
-    canvas.SaveAs((output_folder + "P_rec_P_gen.pdf").c_str());
-    std::cout << "Saved 1D histogram as P_rec_P_gen.pdf" << std::endl;
+    plot_registry().Book({hist1, hist2}, [=]() mutable {
+        TCanvas canvas("c6", "P_rec VS P_gen", 800, 600);
+        canvas.Divide(1,2);
+        canvas.cd(1);
+        hist1->Draw();
+        canvas.cd(2);
+        hist2->Draw();
+
+        canvas.SaveAs((output_folder + "P_rec_P_gen.pdf").c_str());
+        std::cout << "Saved 1D histogram as P_rec_P_gen.pdf" << std::endl;
+    });
 }
 
 
 
 void Theta_VS_momentum_FD_CD(ROOT::RDF::RNode rdf, const std::string& output_folder) {
-    TCanvas canvas("c8", "Theta VS momentum FD CD", 800, 600);
-    canvas.Divide(2,2);
-    canvas.cd(1);
-    auto hist1 = rdf.Filter("detector == \"FD\"").Histo2D(ROOT::RDF::TH2DModel("Theta_gen_VS_P_gen_FD", "Theta_gen VS P_gen in FD; P_gen (GeV); Theta_gen (deg)", 100, 0, 5, 100, 0, 100),  "p_proton_gen", "Theta_gen" );
-    hist1->Draw("COLZ");
-    canvas.cd(2);
-    auto hist2 = rdf.Filter("detector == \"FD\"").Histo2D(ROOT::RDF::TH2DModel("Theta_rec_VS_P_rec_FD", "Theta_rec VS P_rec in FD;  P_rec (GeV); Theta_rec (deg);", 100, 0, 5, 100, 0, 100), "p_proton_rec", "Theta_rec"  );
-    hist2->Draw("COLZ");
-    canvas.cd(3);
-    auto hist3 = rdf.Filter("detector == \"CD\"").Histo2D(ROOT::RDF::TH2DModel("Theta_gen_VS_P_gen_CD", "Theta_gen VS P_gen in CD; P_gen (GeV); Theta_gen (deg); ", 100, 0, 5, 100, 0, 100), "p_proton_gen", "Theta_gen");
-    hist3->Draw("COLZ");
-    canvas.cd(4);
-    auto hist4 = rdf.Filter("detector == \"CD\"").Histo2D(ROOT::RDF::TH2DModel("Theta_rec_VS_P_rec_CD", "Theta_rec VS P_rec in CD;  P_rec (GeV); Theta_rec (deg);",  100, 0, 5, 100, 0, 100), "p_proton_rec", "Theta_rec");
-    hist4->Draw("COLZ");
-
-    canvas.SaveAs((output_folder + "Theta_VS_momentum_FD_CD.pdf").c_str());
-    std::cout << "Saved 2D histogram as Theta_VS_momentum_FD_CD.pdf" << std::endl;
+    auto hist1 = rdf.Filter("is_FD").Histo2D(ROOT::RDF::TH2DModel("Theta_gen_VS_P_gen_FD", "Theta_gen VS P_gen in FD; P_gen (GeV); Theta_gen (deg)", 100, 0, 5, 100, 0, 100),  "p_proton_gen", "Theta_gen" );
+    auto hist2 = rdf.Filter("is_FD").Histo2D(ROOT::RDF::TH2DModel("Theta_rec_VS_P_rec_FD", "Theta_rec VS P_rec in FD;  P_rec (GeV); Theta_rec (deg);", 100, 0, 5, 100, 0, 100), "p_proton_rec", "Theta_rec"  );
+    auto hist3 = rdf.Filter("is_CD").Histo2D(ROOT::RDF::TH2DModel("Theta_gen_VS_P_gen_CD", "Theta_gen VS P_gen in CD; P_gen (GeV); Theta_gen (deg); ", 100, 0, 5, 100, 0, 100), "p_proton_gen", "Theta_gen");
+    auto hist4 = rdf.Filter("is_CD").Histo2D(ROOT::RDF::TH2DModel("Theta_rec_VS_P_rec_CD", "Theta_rec VS P_rec in CD;  P_rec (GeV); Theta_rec (deg);",  100, 0, 5, 100, 0, 100), "p_proton_rec", "Theta_rec");
+
+    plot_registry().Book({hist1, hist2, hist3, hist4}, [=]() mutable {
+        TCanvas canvas("c8", "Theta VS momentum FD CD", 800, 600);
+        canvas.Divide(2,2);
+        canvas.cd(1);
+        hist1->Draw("COLZ");
+        canvas.cd(2);
+        hist2->Draw("COLZ");
+        canvas.cd(3);
+        hist3->Draw("COLZ");
+        canvas.cd(4);
+        hist4->Draw("COLZ");
+
+        canvas.SaveAs((output_folder + "Theta_VS_momentum_FD_CD.pdf").c_str());
+        std::cout << "Saved 2D histogram as Theta_VS_momentum_FD_CD.pdf" << std::endl;
+    });
 }
 
 
 
 void Phi_VS_momentum_FD_CD(ROOT::RDF::RNode rdf, const std::string& output_folder) {
-    TCanvas canvas("c8", "Phi VS momentum FD CD", 800, 600);
-    canvas.Divide(2,2);
-    canvas.cd(1);
-    auto hist1 = rdf.Filter("detector == \"FD\"").Histo2D(ROOT::RDF::TH2DModel("Phi_gen_VS_P_gen_FD", "Phi_gen VS P_gen in FD;  Phi_gen (deg); P_gen (GeV)", 100, -200, 200, 100, 0, 5), "Phi_gen", "p_proton_gen" );
-    hist1->Draw("COLZ");
-    canvas.cd(2);
-    auto hist2 = rdf.Filter("detector == \"FD\"").Histo2D(ROOT::RDF::TH2DModel("Phi_rec_VS_P_rec_FD", "Phi_rec VS P_rec in FD;  Phi_rec (deg); P_rec (GeV)", 100, -200, 200, 100, 0, 5), "Phi_rec", "p_proton_rec" );
-    hist2->Draw("COLZ");
-    canvas.cd(3);
-    auto hist3 = rdf.Filter("detector == \"CD\"").Histo2D(ROOT::RDF::TH2DModel("Phi_gen_VS_P_gen_CD", "Phi_gen VS P_gen in CD; Phi_gen (deg); P_gen (GeV)", 100, -200, 200, 100, 0, 5), "Phi_gen", "p_proton_gen");
-    hist3->Draw("COLZ");
-    canvas.cd(4);
-    auto hist4 = rdf.Filter("detector == \"CD\"").Histo2D(ROOT::RDF::TH2DModel("Phi_rec_VS_P_rec_CD", "Phi_rec VS P_rec in CD; Phi_rec (deg); P_rec (GeV)", 100, -200, 200, 100, 0, 5), "Phi_rec", "p_proton_rec");
-    hist4->Draw("COLZ");
-
-    canvas.SaveAs((output_folder + "Phi_VS_momentum_FD_CD.pdf").c_str());
-    std::cout << "Saved 2D histogram as Phi_VS_momentum_FD_CD.pdf" << std::endl;
+    auto hist1 = rdf.Filter("is_FD").Histo2D(ROOT::RDF::TH2DModel("Phi_gen_VS_P_gen_FD", "Phi_gen VS P_gen in FD;  Phi_gen (deg); P_gen (GeV)", 100, -200, 200, 100, 0, 5), "Phi_gen", "p_proton_gen" );
+    auto hist2 = rdf.Filter("is_FD").Histo2D(ROOT::RDF::TH2DModel("Phi_rec_VS_P_rec_FD", "Phi_rec VS P_rec in FD;  Phi_rec (deg); P_rec (GeV)", 100, -200, 200, 100, 0, 5), "Phi_rec", "p_proton_rec" );
+    auto hist3 = rdf.Filter("is_CD").Histo2D(ROOT::RDF::TH2DModel("Phi_gen_VS_P_gen_CD", "Phi_gen VS P_gen in CD; Phi_gen (deg); P_gen (GeV)", 100, -200, 200, 100, 0, 5), "Phi_gen", "p_proton_gen");
+    auto hist4 = rdf.Filter("is_CD").Histo2D(ROOT::RDF::TH2DModel("Phi_rec_VS_P_rec_CD", "Phi_rec VS P_rec in CD; Phi_rec (deg); P_rec (GeV)", 100, -200, 200, 100, 0, 5), "Phi_rec", "p_proton_rec");
+
+    plot_registry().Book({hist1, hist2, hist3, hist4}, [=]() mutable {
+        TCanvas canvas("c8", "Phi VS momentum FD CD", 800, 600);
+        canvas.Divide(2,2);
+        canvas.cd(1);
+        hist1->Draw("COLZ");
+        canvas.cd(2);
+        hist2->Draw("COLZ");
+        canvas.cd(3);
+        hist3->Draw("COLZ");
+        canvas.cd(4);
+        hist4->Draw("COLZ");
+
+        canvas.SaveAs((output_folder + "Phi_VS_momentum_FD_CD.pdf").c_str());
+        std::cout << "Saved 2D histogram as Phi_VS_momentum_FD_CD.pdf" << std::endl;
+    });
 }
 
 
 void Phi_VS_Theta_FD_CD(ROOT::RDF::RNode rdf, const std::string& output_folder) {
-    TCanvas canvas("c10", "Phi VS Theta FD CD", 800, 600);
-    canvas.Divide(2,2);
-    canvas.cd(1);
-    auto hist1 = rdf.Filter("detector == \"FD\"").Histo2D(ROOT::RDF::TH2DModel("Phi_gen_VS_Theta_gen_FD", "Phi_gen VS Theta_gen in FD;  Phi_gen (deg); Theta_gen (deg)", 100, -200, 200, 100, 0, 100), "Phi_gen", "Theta_gen" );
-    hist1->Draw("COLZ");
-    canvas.cd(2);
-    auto hist2 = rdf.Filter("detector == \"FD\"").Histo2D(ROOT::RDF::TH2DModel("Phi_rec_VS_Theta_rec_FD", "Phi_rec VS Theta_rec in FD;  Phi_rec (deg); Theta_rec (deg)", 100, -200, 200, 100, 0, 100), "Phi_rec", "Theta_rec" );
-    hist2->Draw("COLZ");
-    canvas.cd(3);
-    auto hist3 = rdf.Filter("detector == \"CD\"").Histo2D(ROOT::RDF::TH2DModel("Phi_gen_VS_Theta_gen_CD", "Phi_gen VS Theta_gen in CD; Phi_gen (deg); Theta_gen (deg)", 100, -200, 200, 100, 0, 100), "Phi_gen", "Theta_gen");
-    hist3->Draw("COLZ");
-    canvas.cd(4);
-    auto hist4 = rdf.Filter("detector == \"CD\"").Histo2D(ROOT::RDF::TH2DModel("Phi_rec_VS_Theta_rec_CD", "Phi_rec VS Theta_rec in CD; Phi_rec (deg); Theta_rec (deg)", 100, -200, 200, 100, 0, 100), "Phi_rec", "Theta_rec");
-    hist4->Draw("COLZ");
-
-    canvas.SaveAs((output_folder + "Phi_VS_Theta_FD_CD.pdf").c_str());
-    std::cout << "Saved 2D histogram as Phi_VS_Theta_FD_CD.pdf" << std::endl;
+    auto hist1 = rdf.Filter("is_FD").Histo2D(ROOT::RDF::TH2DModel("Phi_gen_VS_Theta_gen_FD", "Phi_gen VS Theta_gen in FD;  Phi_gen (deg); Theta_gen (deg)", 100, -200, 200, 100, 0, 100), "Phi_gen", "Theta_gen" );
+    auto hist2 = rdf.Filter("is_FD").Histo2D(ROOT::RDF::TH2DModel("Phi_rec_VS_Theta_rec_FD", "Phi_rec VS Theta_rec in FD;  Phi_rec (deg); Theta_rec (deg)", 100, -200, 200, 100, 0, 100), "Phi_rec", "Theta_rec" );
+    auto hist3 = rdf.Filter("is_CD").Histo2D(ROOT::RDF::TH2DModel("Phi_gen_VS_Theta_gen_CD", "Phi_gen VS Theta_gen in CD; Phi_gen (deg); Theta_gen (deg)", 100, -200, 200, 100, 0, 100), "Phi_gen", "Theta_gen");
+    auto hist4 = rdf.Filter("is_CD").Histo2D(ROOT::RDF::TH2DModel("Phi_rec_VS_Theta_rec_CD", "Phi_rec VS Theta_rec in CD; Phi_rec (deg); Theta_rec (deg)", 100, -200, 200, 100, 0, 100), "Phi_rec", "Theta_rec");
+
+    plot_registry().Book({hist1, hist2, hist3, hist4}, [=]() mutable {
+        TCanvas canvas("c10", "Phi VS Theta FD CD", 800, 600);
+        canvas.Divide(2,2);
+        canvas.cd(1);
+        hist1->Draw("COLZ");
+        canvas.cd(2);
+        hist2->Draw("COLZ");
+        canvas.cd(3);
+        hist3->Draw("COLZ");
+        canvas.cd(4);
+        hist4->Draw("COLZ");
+
+        canvas.SaveAs((output_folder + "Phi_VS_Theta_FD_CD.pdf").c_str());
+        std::cout << "Saved 2D histogram as Phi_VS_Theta_FD_CD.pdf" << std::endl;
+    });
 }
 
 void delta_P_VS_P_rec_FD_CD(ROOT::RDF::RNode rdf, const std::string& output_folder) {
-    TCanvas canvas("c", "delta_P_VS_P_rec_FD_CD", 800, 600);
-    canvas.Divide(1,2);
-    canvas.cd(1);
-    auto hist2D_1 = rdf.Filter("detector == \"FD\"").Histo2D(ROOT::RDF::TH2DModel("delta_P_VS_P_rec_FD", "delta P vs P_rec in FD;  P_rec (GeV); delta P (GeV)", 100, 0, 2.5, 100, -0.1, 0.1), "p_proton_rec", "delta_p");
-    hist2D_1->Draw("COLZ");
-    canvas.cd(2);
-    auto hist2D_2 = rdf.Filter("detector == \"CD\"").Histo2D(ROOT::RDF::TH2DModel("delta_P_VS_P_rec_CD", "delta P vs P_rec in CD;  P_rec (GeV); delta P (GeV)", 100, 0, 2.5, 100, -0.1, 0.1), "p_proton_rec", "delta_p");
-    hist2D_2->Draw("COLZ");
-
-    canvas.SaveAs((output_folder + "delta_P_VS_P_rec_FD_CD.pdf").c_str());
-    std::cout << "Saved 2D histogram as delta_P_VS_P_rec_FD_CD.pdf" << std::endl;
+    auto hist2D_1 = rdf.Filter("is_FD").Histo2D(ROOT::RDF::TH2DModel("delta_P_VS_P_rec_FD", "delta P vs P_rec in FD;  P_rec (GeV); delta P (GeV)", 100, 0, 2.5, 100, -0.1, 0.1), "p_proton_rec", "delta_p");
+    auto hist2D_2 = rdf.Filter("is_CD").Histo2D(ROOT::RDF::TH2DModel("delta_P_VS_P_rec_CD", "delta P vs P_rec in CD;  P_rec (GeV); delta P (GeV)", 100, 0, 2.5, 100, -0.1, 0.1), "p_proton_rec", "delta_p");
+
+    plot_registry().Book({hist2D_1, hist2D_2}, [=]() mutable {
+        TCanvas canvas("c", "delta_P_VS_P_rec_FD_CD", 800, 600);
+        canvas.Divide(1,2);
+        canvas.cd(1);
+        hist2D_1->Draw("COLZ");
+        canvas.cd(2);
+        hist2D_2->Draw("COLZ");
+
+        canvas.SaveAs((output_folder + "delta_P_VS_P_rec_FD_CD.pdf").c_str());
+        std::cout << "Saved 2D histogram as delta_P_VS_P_rec_FD_CD.pdf" << std::endl;
+    });
 }
 
 
 
 void delta_P_VS_P_rec_FD_sectors_2D(ROOT::RDF::RNode rdf, const std::string& output_folder) {
     // Apply initial filter for detector
-    auto rdf_filtered = rdf.Filter("detector == \"FD\"");
+    auto rdf_filtered = rdf.Filter("is_FD");
     // Create 3D histogram: X = p_proton_rec, Y = delta_p, Z = sector_proton
     auto hist3D = rdf_filtered.Histo3D(
         ROOT::RDF::TH3DModel("delta_P_VS_P_rec_FD_3D",
@@ -272,28 +277,30 @@ void delta_P_VS_P_rec_FD_sectors_2D(ROOT::RDF::RNode rdf, const std::string& out
         "p_proton_rec", "delta_p", "sector_proton"
     );
 
-    // Prepare Canvas
-    TCanvas canvas("c", "delta_P_VS_P_rec_FD_sectors", 800, 600);
-    canvas.Divide(3,2);
+    plot_registry().Book({hist3D}, [=]() mutable {
+        // Prepare Canvas
+        TCanvas canvas("c", "delta_P_VS_P_rec_FD_sectors", 800, 600);
+        canvas.Divide(3,2);
 
-    // Slice 3D Histogram into 2D Histograms for each sector
-    for (int sector = 1; sector <= 6; ++sector) {
-        canvas.cd(sector);
+        // Slice 3D Histogram into 2D Histograms for each sector
+        for (int sector = 1; sector <= 6; ++sector) {
+            canvas.cd(sector);
 
-        // Set Z-axis range to only include the current sector
-        hist3D->GetZaxis()->SetRange(sector, sector);
+            // Set Z-axis range to only include the current sector
+            hist3D->GetZaxis()->SetRange(sector, sector);
 
-        // Project X-Y plane (p_proton_rec vs delta_p) for this sector
-        auto hist2D = hist3D->Project3D("yx"); // Correct projection: Y = delta_p, X = p_proton_rec
-        hist2D->SetName(Form("delta_P_VS_P_rec_FD_sector%d", sector));
-        hist2D->SetTitle(Form("delta P vs P_rec Sector %d; P_rec (GeV); delta P (GeV)", sector));
+            // Project X-Y plane (p_proton_rec vs delta_p) for this sector
+            auto hist2D = hist3D->Project3D("yx"); // Correct projection: Y = delta_p, X = p_proton_rec
+            hist2D->SetName(Form("delta_P_VS_P_rec_FD_sector%d", sector));
+            hist2D->SetTitle(Form("delta P vs P_rec Sector %d; P_rec (GeV); delta P (GeV)", sector));
 
-        hist2D->Draw("COLZ");
-    }
+            hist2D->Draw("COLZ");
+        }
 
-    // Save the final canvas
-    canvas.SaveAs((output_folder + "delta_P_VS_P_rec_FD_sectors.pdf").c_str());
-    std::cout << "Saved 2D histograms from 3D histogram as delta_P_VS_P_rec_FD_sectors.pdf" << std::endl;
+        // Save the final canvas
+        canvas.SaveAs((output_folder + "delta_P_VS_P_rec_FD_sectors.pdf").c_str());
+        std::cout << "Saved 2D histograms from 3D histogram as delta_P_VS_P_rec_FD_sectors.pdf" << std::endl;
+    });
 }
 
 void delta_P_VS_P_rec_FD_sectors_1D_theta_sliced(ROOT::RDF::RNode rdf, const std::string& output_folder, const bool normalized) {
@@ -314,99 +321,101 @@ void delta_P_VS_P_rec_FD_sectors_1D_theta_sliced(ROOT::RDF::RNode rdf, const std
         std::string theta_label = Form("theta_%.0f_%.0f", theta_min, theta_max);
 
         // Filter by theta and detector
-        ROOT::RDF::RNode rdf_filtered = rdf.Filter(Form("detector == \"FD\" && Theta_rec >= %.2f && Theta_rec < %.2f && DC_fiducial_cut_electron == true && DC_fiducial_cut_proton == true", theta_min, theta_max));
+        ROOT::RDF::RNode rdf_filtered = rdf.Filter(Form("is_FD && Theta_rec >= %.2f && Theta_rec < %.2f && DC_fiducial_cut_electron == true && DC_fiducial_cut_proton == true", theta_min, theta_max));
 
         auto hist3D = normalized
             ? rdf_filtered.Histo3D(
-                  ROOT::RDF::TH3DModel("delta_p/p_VS_P_rec_FD_3D",
+                  ROOT::RDF::TH3DModel(("delta_P_VS_P_rec_FD_sectors_1D_" + theta_label + "_" + dp_Or_dpp).c_str(),
                                        "delta_p/p vs P_rec vs Sector;P_rec (GeV);delta_p/p;Sector",
                                        100, 0, 2.5, 100, -0.2, 0.1, 6, 0, 7),
                   "p_proton_rec", "dp_norm", "sector_proton")
             : rdf_filtered.Histo3D(
-                  ROOT::RDF::TH3DModel("delta_P_VS_P_rec_FD_3D",
+                  ROOT::RDF::TH3DModel(("delta_P_VS_P_rec_FD_sectors_1D_" + theta_label + "_" + dp_Or_dpp).c_str(),
                                        "delta P vs P_rec vs Sector;P_rec (GeV/c);delta P (GeV/c);Sector",
                                        100, 0, 2.5, 100, -0.1, 0.1, 6, 0, 7),
                   "p_proton_rec", "delta_p", "sector_proton");
 
-        std::vector<TGraphErrors*> sector_graphs(6, nullptr);
-        for (int i = 0; i < 6; ++i) {
-            sector_graphs[i] = new TGraphErrors();
-            sector_graphs[i]->SetName(Form("gSector%d_%s", i + 1, theta_label.c_str()));
-            sector_graphs[i]->SetTitle(Form("Sector %d (%s);Momentum Bin Center (GeV/c);Mean %s (GeV/c)", i + 1, theta_label.c_str(), dp_Or_dpp.c_str()));
-        }
+        plot_registry().Book({hist3D}, [=]() mutable {
+            std::vector<TGraphErrors*> sector_graphs(6, nullptr);
+            for (int i = 0; i < 6; ++i) {
+                sector_graphs[i] = new TGraphErrors();
+                sector_graphs[i]->SetName(Form("gSector%d_%s", i + 1, theta_label.c_str()));
+                sector_graphs[i]->SetTitle(Form("Sector %d (%s);Momentum Bin Center (GeV/c);Mean %s (GeV/c)", i + 1, theta_label.c_str(), dp_Or_dpp.c_str()));
+            }
 
-        for (int sector = 1; sector <= 6; ++sector) {
-            TCanvas* c = new TCanvas(Form("sector_canvas_%d_%s", sector, theta_label.c_str()),
-                                     Form("%s slices in Sector %d, Theta [%.0f, %.0f]", dp_Or_dpp.c_str(), sector, theta_min, theta_max),
-                                     1200, 800);
-            c->Divide(5, 5);
+            for (int sector = 1; sector <= 6; ++sector) {
+                TCanvas* c = new TCanvas(Form("sector_canvas_%d_%s", sector, theta_label.c_str()),
+                                         Form("%s slices in Sector %d, Theta [%.0f, %.0f]", dp_Or_dpp.c_str(), sector, theta_min, theta_max),
+                                         1200, 800);
+                c->Divide(5, 5);
 
-            hist3D->GetZaxis()->SetRange(sector, sector);
+                hist3D->GetZaxis()->SetRange(sector, sector);
 
-            for (size_t bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
-                double p_low = momentum_bins[bin_idx];
-                double p_high = momentum_bins[bin_idx + 1];
-                double p_center = 0.5 * (p_low + p_high);
+                for (size_t bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
+                    double p_low = momentum_bins[bin_idx];
+                    double p_high = momentum_bins[bin_idx + 1];
+                    double p_center = 0.5 * (p_low + p_high);
 
-                hist3D->GetXaxis()->SetRangeUser(p_low, p_high);
-                TH1* hist1D = hist3D->Project3D("y");
+                    hist3D->GetXaxis()->SetRangeUser(p_low, p_high);
+                    TH1* hist1D = hist3D->Project3D("y");
 
-                hist1D->SetName(Form("%s_%s_sector%d_bin%zu", theta_label.c_str(), dp_Or_dpp.c_str(), sector, bin_idx + 1));
-                hist1D->SetTitle(Form("Theta [%.0f,%.0f] Sector %d: %.2f - %.2f GeV;%s (GeV/c);Counts",
-                                      theta_min, theta_max, sector, p_low, p_high, dp_Or_dpp.c_str()));
+                    hist1D->SetName(Form("%s_%s_sector%d_bin%zu", theta_label.c_str(), dp_Or_dpp.c_str(), sector, bin_idx + 1));
+                    hist1D->SetTitle(Form("Theta [%.0f,%.0f] Sector %d: %.2f - %.2f GeV;%s (GeV/c);Counts",
+                                          theta_min, theta_max, sector, p_low, p_high, dp_Or_dpp.c_str()));
 
-                c->cd(bin_idx + 1);
-                hist1D->Draw();
+                    c->cd(bin_idx + 1);
+                    hist1D->Draw();
 
-                TF1* fit_init = new TF1("gaus_init", "gaus", -0.02, 0.02);
-                hist1D->Fit(fit_init, "RQ0");
+                    TF1* fit_init = new TF1("gaus_init", "gaus", -0.02, 0.02);
+                    hist1D->Fit(fit_init, "RQ0");
 
-                double mean_init = fit_init->GetParameter(1);
-                double sigma_init = fit_init->GetParameter(2);
+                    double mean_init = fit_init->GetParameter(1);
+                    double sigma_init = fit_init->GetParameter(2);
 
-                double fit_min = mean_init - sigma_init;
-                double fit_max = mean_init + sigma_init;
-                TF1* fit_refined = new TF1("gaus_refined", "gaus", fit_min, fit_max);
-                hist1D->Fit(fit_refined, "RQ");
+                    double fit_min = mean_init - sigma_init;
+                    double fit_max = mean_init + sigma_init;
+                    TF1* fit_refined = new TF1("gaus_refined", "gaus", fit_min, fit_max);
+                    hist1D->Fit(fit_refined, "RQ");
 
-                double mean = fit_refined->GetParameter(1);
-                double sigma = fit_refined->GetParameter(2);
+                    double mean = fit_refined->GetParameter(1);
+                    double sigma = fit_refined->GetParameter(2);
 
-                TGraphErrors* graph = sector_graphs[sector - 1];
-                graph->SetPoint(bin_idx, p_center, mean);
-                graph->SetPointError(bin_idx, 0.0, sigma);
-            }
+                    TGraphErrors* graph = sector_graphs[sector - 1];
+                    graph->SetPoint(bin_idx, p_center, mean);
+                    graph->SetPointError(bin_idx, 0.0, sigma);
+                }
 
-            c->SaveAs((output_folder + Form("%s_%s_sector%d_bins.pdf", theta_label.c_str(), dp_Or_dpp.c_str(), sector)).c_str());
-            delete c;
-        }
+                c->SaveAs((output_folder + Form("%s_%s_sector%d_bins.pdf", theta_label.c_str(), dp_Or_dpp.c_str(), sector)).c_str());
+                delete c;
+            }
 
-        // Summary canvas
-        TCanvas* summaryCanvas = new TCanvas(Form("summaryCanvas_%s", theta_label.c_str()),
-                                             Form("Mean %s vs Momentum Bin per Sector (%s)", dp_Or_dpp.c_str(), theta_label.c_str()), 1400, 1000);
-        summaryCanvas->Divide(3, 2);
-
-        for (int i = 0; i < 6; ++i) {
-            summaryCanvas->cd(i + 1);
-            TGraphErrors* g = sector_graphs[i];
-            g->SetMarkerStyle(20);
-            g->SetMarkerColor(kBlack);
-            g->SetLineColor(kBlack);
-            g->Draw("AP");
-
-            gPad->SetGrid();
-
-            double xmin = 0.25;
-            double xmax = 2.5;
-            TLine* zeroLine = new TLine(xmin, 0.0, xmax, 0.0);
-            zeroLine->SetLineColor(kRed);
-            zeroLine->SetLineStyle(2);
-            zeroLine->SetLineWidth(2);
-            zeroLine->Draw("SAME");
-        }
+            // Summary canvas
+            TCanvas* summaryCanvas = new TCanvas(Form("summaryCanvas_%s", theta_label.c_str()),
+                                                 Form("Mean %s vs Momentum Bin per Sector (%s)", dp_Or_dpp.c_str(), theta_label.c_str()), 1400, 1000);
+            summaryCanvas->Divide(3, 2);
+
+            for (int i = 0; i < 6; ++i) {
+                summaryCanvas->cd(i + 1);
+                TGraphErrors* g = sector_graphs[i];
+                g->SetMarkerStyle(20);
+                g->SetMarkerColor(kBlack);
+                g->SetLineColor(kBlack);
+                g->Draw("AP");
+
+                gPad->SetGrid();
+
+                double xmin = 0.25;
+                double xmax = 2.5;
+                TLine* zeroLine = new TLine(xmin, 0.0, xmax, 0.0);
+                zeroLine->SetLineColor(kRed);
+                zeroLine->SetLineStyle(2);
+                zeroLine->SetLineWidth(2);
+                zeroLine->Draw("SAME");
+            }
 
-        summaryCanvas->SaveAs((output_folder + theta_label + "_mean_" + dp_Or_dpp + "_vs_momentum_bin_by_sector.pdf").c_str());
-        std::cout << "Saved summary plot for theta bin [" << theta_min << ", " << theta_max << ")\n";
+            summaryCanvas->SaveAs((output_folder + theta_label + "_mean_" + dp_Or_dpp + "_vs_momentum_bin_by_sector.pdf").c_str());
+            std::cout << "Saved summary plot for theta bin [" << theta_min << ", " << theta_max << ")\n";
+        });
     }
 }
 
@@ -417,46 +426,49 @@ void delta_P_VS_P_rec_FD_sectors_2D_theta_sliced(ROOT::RDF::RNode rdf, const std
     std::vector<std::pair<double, double>> theta_bins = {
        {0,180}
     };
-    for (const auto& [theta_min, theta_max] : theta_bins) {
+    for (const auto& theta_bin : theta_bins) {
+        const double theta_min = theta_bin.first, theta_max = theta_bin.second;  // lambdas cannot capture structured bindings in C++17
         std::string theta_label = Form("theta_%.0f_%.0f", theta_min, theta_max);
 
         // Filter by theta and detector
         ROOT::RDF::RNode rdf_DC_cut_filtered = rdf.Filter("DC_fiducial_cut_proton == true && DC_fiducial_cut_electron == true");
-        ROOT::RDF::RNode rdf_filtered = rdf.Filter(Form("detector == \"FD\" && Theta_rec >= %.2f && Theta_rec < %.2f", theta_min, theta_max));
+        ROOT::RDF::RNode rdf_filtered = rdf.Filter(Form("is_FD && Theta_rec >= %.2f && Theta_rec < %.2f", theta_min, theta_max));
 
         auto hist3D = normalized
             ? rdf_filtered.Histo3D(
-                  ROOT::RDF::TH3DModel("delta_p/p_VS_P_rec_FD_3D",
+                  ROOT::RDF::TH3DModel(("delta_P_VS_P_rec_FD_sectors_2D_" + theta_label + "_" + dp_Or_dpp).c_str(),
                                        "delta_p/p vs P_rec vs Sector;P_rec (GeV);delta_p/p;Sector",
                                        100, 0, 5.0, 100, -0.2, 0.1, 6, 0, 7),
                   "p_proton_rec", "dp_norm", "sector_proton")
             : rdf_filtered.Histo3D(
-                  ROOT::RDF::TH3DModel("delta_P_VS_P_rec_FD_3D",
+                  ROOT::RDF::TH3DModel(("delta_P_VS_P_rec_FD_sectors_2D_" + theta_label + "_" + dp_Or_dpp).c_str(),
                                        "delta P vs P_rec vs Sector;P_rec (GeV/c);delta P (GeV/c);Sector",
                                        100, 0, 5.0, 100, -0.1, 0.1, 6, 0, 7),
                   "p_proton_rec", "delta_p", "sector_proton");
 
-        TCanvas* c_all_sectors = new TCanvas(Form("c2D_allSectors_%s", theta_label.c_str()),
-                                             Form("Δp vs P_rec for all sectors (Theta %.0f–%.0f)", theta_min, theta_max),
-                                             1800, 1200);
-        c_all_sectors->Divide(3, 2);
+        plot_registry().Book({hist3D}, [=]() mutable {
+            TCanvas* c_all_sectors = new TCanvas(Form("c2D_allSectors_%s", theta_label.c_str()),
+                                                 Form("Δp vs P_rec for all sectors (Theta %.0f–%.0f)", theta_min, theta_max),
+                                                 1800, 1200);
+            c_all_sectors->Divide(3, 2);
 
-        for (int sector = 1; sector <= 6; ++sector) {
-            hist3D->GetZaxis()->SetRange(sector, sector);
+            for (int sector = 1; sector <= 6; ++sector) {
+                hist3D->GetZaxis()->SetRange(sector, sector);
 
-            // Clone the projection so each sector gets its own copy
-            TH2D* hist2D = (TH2D*)hist3D->Project3D("yx")->Clone(Form("h2D_sector%d_%s", sector, theta_label.c_str()));
-            hist2D->SetTitle(Form("Sector %d;P_rec (GeV/c);%s", sector, dp_Or_dpp.c_str()));
+                // Clone the projection so each sector gets its own copy
+                TH2D* hist2D = (TH2D*)hist3D->Project3D("yx")->Clone(Form("h2D_sector%d_%s", sector, theta_label.c_str()));
+                hist2D->SetTitle(Form("Sector %d;P_rec (GeV/c);%s", sector, dp_Or_dpp.c_str()));
 
-            c_all_sectors->cd(sector);
-            hist2D->Draw("COLZ");
-            gPad->SetRightMargin(0.15);
-        }
+                c_all_sectors->cd(sector);
+                hist2D->Draw("COLZ");
+                gPad->SetRightMargin(0.15);
+            }
 
-        c_all_sectors->SaveAs((output_folder + theta_label + "_2D_all_sectors_" + dp_Or_dpp + ".pdf").c_str());
-        delete c_all_sectors;
+            c_all_sectors->SaveAs((output_folder + theta_label + "_2D_all_sectors_" + dp_Or_dpp + ".pdf").c_str());
+            delete c_all_sectors;
 
-        std::cout << "Saved combined 2D canvas for theta bin [" << theta_min << ", " << theta_max << ")\n";
+            std::cout << "Saved combined 2D canvas for theta bin [" << theta_min << ", " << theta_max << ")\n";
+        });
     }
 }
 
@@ -472,220 +484,222 @@ void delta_P_VS_P_rec_FD_sectors_1D(ROOT::RDF::RNode rdf,
   ROOT::RDF::RNode rdf_filtered = rdf;
 
   if (thetaBin == "high") {
-    rdf_filtered = rdf.Filter("detector == \"FD\" && Theta_rec >= 33");
+    rdf_filtered = rdf.Filter("is_FD && Theta_rec >= 33");
   } else if (thetaBin == "low") {
-    rdf_filtered = rdf.Filter("detector == \"FD\" && Theta_rec < 27");
+    rdf_filtered = rdf.Filter("is_FD && Theta_rec < 27");
   }
 
   auto hist3D = normalized
       ? rdf_filtered.Histo3D(
-            ROOT::RDF::TH3DModel("delta_p/p_VS_P_rec_FD_3D",
+            ROOT::RDF::TH3DModel(("delta_P_VS_P_rec_FD_sectors_1D_" + thetaBin + "_" + dp_Or_dpp).c_str(),
                                  "delta_p/p vs P_rec vs Sector;P_rec (GeV);delta_p/p;Sector",
                                  100, 0, 2.5, 100, -0.2, 0.1, 6, 0, 7),
             "p_proton_rec", "dp_norm", "sector_proton")
       : rdf_filtered.Histo3D(
-            ROOT::RDF::TH3DModel("delta_P_VS_P_rec_FD_3D",
+            ROOT::RDF::TH3DModel(("delta_P_VS_P_rec_FD_sectors_1D_" + thetaBin + "_" + dp_Or_dpp).c_str(),
                                  "delta P vs P_rec vs Sector;P_rec (GeV/c);delta P (GeV/c);Sector",
                                  100, 0, 2.5, 100, -0.1, 0.1, 6, 0, 7),
             "p_proton_rec", "delta_p", "sector_proton");
 
-  std::vector<double> momentum_bins =
-      (thetaBin == "low")
-          ? std::vector<double>{0.4, 0.5, 0.6, 0.75, 1.0, 1.25, 1.5, 1.75, 2.0, 2.25}
-          : std::vector<double>{0.4, 0.5, 0.6, 0.75, 1.0, 1.25, 1.5, 2.25};
-  const size_t num_bins = momentum_bins.size() - 1;
-
-  std::vector<TGraphErrors*> sector_graphs(6, nullptr);
-  for (int i = 0; i < 6; ++i) {
-    sector_graphs[i] = new TGraphErrors();
-    sector_graphs[i]->SetName(Form("gSector%d", i + 1));
-    sector_graphs[i]->SetTitle(
-        Form("Sector %d;Momentum Bin Center (GeV/c);Mean %s (GeV/c)",
-             i + 1, dp_Or_dpp.c_str()));
-  }
-
-  // Fill graphs (NO skipping, NO error modification)
-  for (int sector = 1; sector <= 6; ++sector) {
-    TCanvas* c = new TCanvas(Form("sector_canvas_%d", sector),
-                             Form("%s slices in Sector %d", dp_Or_dpp.c_str(), sector),
-                             1200, 800);
-    c->Divide(3, 3);
+  plot_registry().Book({hist3D}, [=]() mutable {
+    std::vector<double> momentum_bins =
+        (thetaBin == "low")
+            ? std::vector<double>{0.4, 0.5, 0.6, 0.75, 1.0, 1.25, 1.5, 1.75, 2.0, 2.25}
+            : std::vector<double>{0.4, 0.5, 0.6, 0.75, 1.0, 1.25, 1.5, 2.25};
+    const size_t num_bins = momentum_bins.size() - 1;
 
-    hist3D->GetZaxis()->SetRange(sector, sector);
+    std::vector<TGraphErrors*> sector_graphs(6, nullptr);
+    for (int i = 0; i < 6; ++i) {
+      sector_graphs[i] = new TGraphErrors();
+      sector_graphs[i]->SetName(Form("gSector%d", i + 1));
+      sector_graphs[i]->SetTitle(
+          Form("Sector %d;Momentum Bin Center (GeV/c);Mean %s (GeV/c)",
+               i + 1, dp_Or_dpp.c_str()));
+    }
 
-    for (size_t bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
-      double p_low = momentum_bins[bin_idx];
-      double p_high = momentum_bins[bin_idx + 1];
-      double p_center = 0.5 * (p_low + p_high);
+    // Fill graphs (NO skipping, NO error modification)
+    for (int sector = 1; sector <= 6; ++sector) {
+      TCanvas* c = new TCanvas(Form("sector_canvas_%d", sector),
+                               Form("%s slices in Sector %d", dp_Or_dpp.c_str(), sector),
+                               1200, 800);
+      c->Divide(3, 3);
 
-      hist3D->GetXaxis()->SetRangeUser(p_low, p_high);
-      TH1* hist1D = hist3D->Project3D("y");
-
-      if (thetaBin == "high") {
-        hist1D->SetName(Form("Theta>33_%s_sector%d_bin%zu",
-                             dp_Or_dpp.c_str(), sector, bin_idx + 1));
-        hist1D->SetTitle(Form("Theta > 33 Sector %d: %.2f - %.2f GeV;%s (GeV/c);Counts",
-                              sector, p_low, p_high, dp_Or_dpp.c_str()));
-      } else {
-        hist1D->SetName(Form("Theta<27_%s_sector%d_bin%zu",
-                             dp_Or_dpp.c_str(), sector, bin_idx + 1));
-        hist1D->SetTitle(Form("Theta < 27 Sector %d: %.2f - %.2f GeV;%s (GeV/c);Counts",
-                              sector, p_low, p_high, dp_Or_dpp.c_str()));
-      }
+      hist3D->GetZaxis()->SetRange(sector, sector);
 
-      c->cd(bin_idx + 1);
-      hist1D->Draw();
+      for (size_t bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
+        double p_low = momentum_bins[bin_idx];
+        double p_high = momentum_bins[bin_idx + 1];
+        double p_center = 0.5 * (p_low + p_high);
 
-      TF1* fit_init = new TF1("gaus_init", "gaus", -0.2, 0.01);
-      hist1D->Fit(fit_init, "RQ0");
+        hist3D->GetXaxis()->SetRangeUser(p_low, p_high);
+        TH1* hist1D = hist3D->Project3D("y");
+
+        if (thetaBin == "high") {
+          hist1D->SetName(Form("Theta>33_%s_sector%d_bin%zu",
+                               dp_Or_dpp.c_str(), sector, bin_idx + 1));
+          hist1D->SetTitle(Form("Theta > 33 Sector %d: %.2f - %.2f GeV;%s (GeV/c);Counts",
+                                sector, p_low, p_high, dp_Or_dpp.c_str()));
+        } else {
+          hist1D->SetName(Form("Theta<27_%s_sector%d_bin%zu",
+                               dp_Or_dpp.c_str(), sector, bin_idx + 1));
+          hist1D->SetTitle(Form("Theta < 27 Sector %d: %.2f - %.2f GeV;%s (GeV/c);Counts",
+                                sector, p_low, p_high, dp_Or_dpp.c_str()));
+        }
 
-      double mean_init = fit_init->GetParameter(1);
-      double sigma_init = fit_init->GetParameter(2);
+        c->cd(bin_idx + 1);
+        hist1D->Draw();
 
-      TF1* fit_refined = new TF1("gaus_refined", "gaus",
-                                 mean_init - sigma_init, mean_init + sigma_init);
-      hist1D->Fit(fit_refined, "RQ");
+        TF1* fit_init = new TF1("gaus_init", "gaus", -0.2, 0.01);
+        hist1D->Fit(fit_init, "RQ0");
 
-      double mean = fit_refined->GetParameter(1);
-      double mean_err = fit_refined->GetParError(1);
+        double mean_init = fit_init->GetParameter(1);
+        double sigma_init = fit_init->GetParameter(2);
 
-      // keep original errors; do not floor/modify
-      TGraphErrors* graph = sector_graphs[sector - 1];
-      graph->SetPoint(bin_idx, p_center, mean);
-      graph->SetPointError(bin_idx, 0.0, mean_err);
-    }
+        TF1* fit_refined = new TF1("gaus_refined", "gaus",
+                                   mean_init - sigma_init, mean_init + sigma_init);
+        hist1D->Fit(fit_refined, "RQ");
 
-    c->SaveAs((output_folder + thetaBin +
-               Form("_theta_%s_sector%d_bins.pdf",
-                    dp_Or_dpp.c_str(), sector)).c_str());
-    delete c;
-  }
+        double mean = fit_refined->GetParameter(1);
+        double mean_err = fit_refined->GetParError(1);
 
-  // Summary canvas
-  TCanvas* summaryCanvas =
-      new TCanvas("summaryCanvas",
-                  Form("Mean %s vs Momentum Bin per Sector", dp_Or_dpp.c_str()),
-                  1400, 1000);
-  summaryCanvas->Divide(3, 2);
-
-  for (int i = 0; i < 6; ++i) {
-    summaryCanvas->cd(i + 1);
-    TGraphErrors* g = sector_graphs[i];
-    g->SetMarkerStyle(20);
-    g->SetMarkerSize(1);
-    g->SetMarkerColor(kBlack);
-    g->SetLineColor(kBlack);
-    g->Draw("AP");
-    gPad->Update();
+        // keep original errors; do not floor/modify
+        TGraphErrors* graph = sector_graphs[sector - 1];
+        graph->SetPoint(bin_idx, p_center, mean);
+        graph->SetPointError(bin_idx, 0.0, mean_err);
+      }
 
-    // --- Autoscale axes BUT always include y=0 ---
-    double xmin_pts = 1e9, xmax_pts = -1e9, ymin_pts = 1e9, ymax_pts = -1e9;
-    for (int k = 0; k < g->GetN(); ++k) {
-      double xp, yp; g->GetPoint(k, xp, yp);
-      if (!std::isfinite(xp) || !std::isfinite(yp)) continue;
-      xmin_pts = std::min(xmin_pts, xp);
-      xmax_pts = std::max(xmax_pts, xp);
-      ymin_pts = std::min(ymin_pts, yp);
-      ymax_pts = std::max(ymax_pts, yp);
+      c->SaveAs((output_folder + thetaBin +
+                 Form("_theta_%s_sector%d_bins.pdf",
+                      dp_Or_dpp.c_str(), sector)).c_str());
+      delete c;
     }
-    if (xmin_pts < xmax_pts) {
-      double xpad = 0.05 * (xmax_pts - xmin_pts);
-      double xmin_auto = xmin_pts - xpad;
-      double xmax_auto = xmax_pts + xpad;
 
-      // expand Y to include zero, then add padding
-      ymin_pts = std::min(ymin_pts, 0.0);
-      ymax_pts = std::max(ymax_pts, 0.0);
-      double ypad = 0.10 * std::max(1e-6, ymax_pts - ymin_pts);
-      double ymin_auto = ymin_pts - ypad;
-      double ymax_auto = ymax_pts + ypad;
-
-      g->GetXaxis()->SetLimits(xmin_auto, xmax_auto);
-      g->GetYaxis()->SetRangeUser(ymin_auto, ymax_auto);
-      if (TH1* fr = g->GetHistogram()) {
-        fr->GetXaxis()->SetLimits(xmin_auto, xmax_auto);
-        fr->SetMinimum(ymin_auto);
-        fr->SetMaximum(ymax_auto);
-      }
+    // Summary canvas
+    TCanvas* summaryCanvas =
+        new TCanvas("summaryCanvas",
+                    Form("Mean %s vs Momentum Bin per Sector", dp_Or_dpp.c_str()),
+                    1400, 1000);
+    summaryCanvas->Divide(3, 2);
+
+    for (int i = 0; i < 6; ++i) {
+      summaryCanvas->cd(i + 1);
+      TGraphErrors* g = sector_graphs[i];
+      g->SetMarkerStyle(20);
+      g->SetMarkerSize(1);
+      g->SetMarkerColor(kBlack);
+      g->SetLineColor(kBlack);
+      g->Draw("AP");
       gPad->Update();
-    }
-
-    gPad->SetGrid();
-
-    // Fit range (independent from axis display)
-    double xmin_fit = 0.25, xmax_fit = 2.5;
-
-    // --- Fit: f(p) = A/(p + B) ---
-// Seeds from endpoints; keep the pole left of data
-double pmin = 1e9, pmax = -1e9, pL = 0, yL = 0, pR = 0, yR = 0;
-for (int k = 0; k < g->GetN(); ++k) {
-  double xp, yp; g->GetPoint(k, xp, yp);
-  if (!std::isfinite(xp) || !std::isfinite(yp)) continue;
-  if (xp < pmin) { pmin = xp; pL = xp; yL = yp; }
-  if (xp > pmax) { pmax = xp; pR = xp; yR = yp; }
-}
-
-// A ≈ p*y at high p
-double A0 = (std::isfinite(pR * yR) ? pR * yR : -1e-2);
-if (!std::isfinite(A0)) A0 = -1e-2;
-
-// From y = A/(p+B) ⇒ B = A/y − p (average two endpoint estimates)
-auto seedB = [&](double p, double y) {
-  return (std::abs(y) > 1e-12) ? (A0 / y - p) : (-p + 0.05);
-};
-double B0 = 0.5 * (seedB(pL, yL) + seedB(pR, yR));
-
-// Constrain the pole p = −B to be left of data
-double eps  = 0.02;
-double Bmin = -pmin + eps;
-double Bmax = 5.0;
-if (!std::isfinite(B0) || B0 < Bmin || B0 > Bmax) B0 = Bmin + 0.1;
-
-TF1* fitFunc = new TF1(Form("fit_sector_%d", i + 1),
-                       "[0]/(x + [1])", xmin_fit, xmax_fit);
-fitFunc->SetParNames("A", "B");
-fitFunc->SetParameters(A0, B0);
-fitFunc->SetParLimits(1, Bmin, Bmax); // keep the pole left of data
-fitFunc->SetParLimits(0, -1.0, 0.0);  // A typically negative here; relax if needed
-
-g->Fit(fitFunc, "RQ");
-
-fitFunc->SetLineColor(kBlue);
-fitFunc->SetLineStyle(1);
-fitFunc->Draw("SAME");
-
-double A   = fitFunc->GetParameter(0);
-double B   = fitFunc->GetParameter(1);
-double eA  = fitFunc->GetParError(0);
-double eB  = fitFunc->GetParError(1);
-double chi2 = fitFunc->GetChisquare();
-int ndf     = fitFunc->GetNDF();
-
-TLatex latex;
-latex.SetTextFont(42);
-latex.SetTextSize(0.04);
-latex.SetNDC();
-latex.DrawLatex(0.35, 0.33, Form("A = %.3e #pm %.1e", A, eA));
-latex.DrawLatex(0.35, 0.28, Form("B = %.3e #pm %.1e", B, eB));
-latex.DrawLatex(0.35, 0.23, Form("#chi^{2}/NDF = %.1f / %d = %.2f",
-                                 chi2, ndf, chi2 / ndf));
 
+      // --- Autoscale axes BUT always include y=0 ---
+      double xmin_pts = 1e9, xmax_pts = -1e9, ymin_pts = 1e9, ymax_pts = -1e9;
+      for (int k = 0; k < g->GetN(); ++k) {
+        double xp, yp; g->GetPoint(k, xp, yp);
+        if (!std::isfinite(xp) || !std::isfinite(yp)) continue;
+        xmin_pts = std::min(xmin_pts, xp);
+        xmax_pts = std::max(xmax_pts, xp);
+        ymin_pts = std::min(ymin_pts, yp);
+        ymax_pts = std::max(ymax_pts, yp);
+      }
+      if (xmin_pts < xmax_pts) {
+        double xpad = 0.05 * (xmax_pts - xmin_pts);
+        double xmin_auto = xmin_pts - xpad;
+        double xmax_auto = xmax_pts + xpad;
+
+        // expand Y to include zero, then add padding
+        ymin_pts = std::min(ymin_pts, 0.0);
+        ymax_pts = std::max(ymax_pts, 0.0);
+        double ypad = 0.10 * std::max(1e-6, ymax_pts - ymin_pts);
+        double ymin_auto = ymin_pts - ypad;
+        double ymax_auto = ymax_pts + ypad;
+
+        g->GetXaxis()->SetLimits(xmin_auto, xmax_auto);
+        g->GetYaxis()->SetRangeUser(ymin_auto, ymax_auto);
+        if (TH1* fr = g->GetHistogram()) {
+          fr->GetXaxis()->SetLimits(xmin_auto, xmax_auto);
+          fr->SetMinimum(ymin_auto);
+          fr->SetMaximum(ymax_auto);
+        }
+        gPad->Update();
+      }
 
+      gPad->SetGrid();
 
+      // Fit range (independent from axis display)
+      double xmin_fit = 0.25, xmax_fit = 2.5;
 
-    // y=0 reference line across the current X range
-    double xlo = g->GetXaxis()->GetXmin();
-    double xhi = g->GetXaxis()->GetXmax();
-    TLine* zeroLine = new TLine(xlo, 0.0, xhi, 0.0);
-    zeroLine->SetLineColor(kRed);
-    zeroLine->SetLineStyle(2);
-    zeroLine->SetLineWidth(2);
-    zeroLine->Draw("SAME");
+      // --- Fit: f(p) = A/(p + B) ---
+  // Seeds from endpoints; keep the pole left of data
+  double pmin = 1e9, pmax = -1e9, pL = 0, yL = 0, pR = 0, yR = 0;
+  for (int k = 0; k < g->GetN(); ++k) {
+    double xp, yp; g->GetPoint(k, xp, yp);
+    if (!std::isfinite(xp) || !std::isfinite(yp)) continue;
+    if (xp < pmin) { pmin = xp; pL = xp; yL = yp; }
+    if (xp > pmax) { pmax = xp; pR = xp; yR = yp; }
   }
 
-  summaryCanvas->SaveAs((output_folder + thetaBin +
-                         "_theta_mean_" + dp_Or_dpp +
-                         "_vs_momentum_bin_by_sector.pdf").c_str());
+  // A ≈ p*y at high p
+  double A0 = (std::isfinite(pR * yR) ? pR * yR : -1e-2);
+  if (!std::isfinite(A0)) A0 = -1e-2;
+
+  // From y = A/(p+B) ⇒ B = A/y − p (average two endpoint estimates)
+  auto seedB = [&](double p, double y) {
+    return (std::abs(y) > 1e-12) ? (A0 / y - p) : (-p + 0.05);
+  };
+  double B0 = 0.5 * (seedB(pL, yL) + seedB(pR, yR));
+
+  // Constrain the pole p = −B to be left of data
+  double eps  = 0.02;
+  double Bmin = -pmin + eps;
+  double Bmax = 5.0;
+  if (!std::isfinite(B0) || B0 < Bmin || B0 > Bmax) B0 = Bmin + 0.1;
+
+  TF1* fitFunc = new TF1(Form("fit_sector_%d", i + 1),
+                         "[0]/(x + [1])", xmin_fit, xmax_fit);
+  fitFunc->SetParNames("A", "B");
+  fitFunc->SetParameters(A0, B0);
+  fitFunc->SetParLimits(1, Bmin, Bmax); // keep the pole left of data
+  fitFunc->SetParLimits(0, -1.0, 0.0);  // A typically negative here; relax if needed
+
+  g->Fit(fitFunc, "RQ");
+
+  fitFunc->SetLineColor(kBlue);
+  fitFunc->SetLineStyle(1);
+  fitFunc->Draw("SAME");
+
+  double A   = fitFunc->GetParameter(0);
+  double B   = fitFunc->GetParameter(1);
+  double eA  = fitFunc->GetParError(0);
+  double eB  = fitFunc->GetParError(1);
+  double chi2 = fitFunc->GetChisquare();
+  int ndf     = fitFunc->GetNDF();
+
+  TLatex latex;
+  latex.SetTextFont(42);
+  latex.SetTextSize(0.04);
+  latex.SetNDC();
+  latex.DrawLatex(0.35, 0.33, Form("A = %.3e #pm %.1e", A, eA));
+  latex.DrawLatex(0.35, 0.28, Form("B = %.3e #pm %.1e", B, eB));
+  latex.DrawLatex(0.35, 0.23, Form("#chi^{2}/NDF = %.1f / %d = %.2f",
+                                   chi2, ndf, chi2 / ndf));
+
+
+
+
+      // y=0 reference line across the current X range
+      double xlo = g->GetXaxis()->GetXmin();
+      double xhi = g->GetXaxis()->GetXmax();
+      TLine* zeroLine = new TLine(xlo, 0.0, xhi, 0.0);
+      zeroLine->SetLineColor(kRed);
+      zeroLine->SetLineStyle(2);
+      zeroLine->SetLineWidth(2);
+      zeroLine->Draw("SAME");
+    }
+
+    summaryCanvas->SaveAs((output_folder + thetaBin +
+                           "_theta_mean_" + dp_Or_dpp +
+                           "_vs_momentum_bin_by_sector.pdf").c_str());
+  });
 }
 //--------------------------------------All sectors united---------------------------------------------------
 
@@ -699,300 +713,310 @@ void delta_P_VS_P_rec_FD_unified_1D(ROOT::RDF::RNode rdf,
 
   // Theta selection (no sector separation)
   if (thetaBin == "high") {
-    rdf_filtered = rdf.Filter("detector == \"FD\" && Theta_rec >= 33");
+    rdf_filtered = rdf.Filter("is_FD && Theta_rec >= 33");
   } else if (thetaBin == "low") {
-    rdf_filtered = rdf.Filter("detector == \"FD\" && Theta_rec < 27");
+    rdf_filtered = rdf.Filter("is_FD && Theta_rec < 27");
   }
 
   // 2D histogram over ALL sectors: X = p_rec, Y = Δp (or Δp/p)
   auto h2 = normalized
       ? rdf_filtered.Histo2D(
-            ROOT::RDF::TH2DModel("h2_unified",
+            ROOT::RDF::TH2DModel(("h2_unified_" + thetaBin + "_" + dp_Or_dpp).c_str(),
                                  "delta_p/p vs P_{rec} (FD, all sectors);P_{rec} (GeV/c);delta_p/p",
                                  100, 0.0, 6.0, 200, -0.15, 0.05),
             "p_proton_rec", "dp_norm")
       : rdf_filtered.Histo2D(
-            ROOT::RDF::TH2DModel("h2_unified",
+            ROOT::RDF::TH2DModel(("h2_unified_" + thetaBin + "_" + dp_Or_dpp).c_str(),
                                  "delta P vs P_{rec} (FD, all sectors);P_{rec} (GeV/c);delta P (GeV/c)",
                                  100, 0.0, 6.0, 200, -0.15, 0.15),
             "p_proton_rec", "delta_p");
 
-  // Momentum-bin edges (same as your sector version)
-  std::vector<double> momentum_bins =
-      (thetaBin == "low")
-          ? std::vector<double>{0.4, 0.6, 0.8, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0, 2.2, 2.4, 2.6, 3.0, 3.2, 3.4, 3.6, 3.8, 4.0, 4.2, 4.4, 4.6, 4.8, 5.0} 
-          : std::vector<double>{0.4, 0.6, 0.8, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0, 2.2, 2.4, 2.6, 2.8, 3.0};
-  const size_t num_bins = momentum_bins.size() - 1;
-
-  // Slices canvas (show all momentum-bin projections)
-  const int nCols = 6;
-  const int nRows = 6; // fits 7–9 bins used here
-  TCanvas* cSlices = new TCanvas(Form("unified_%s_slices", thetaBin.c_str()),
-                                 Form("Unified %s slices (FD, all sectors)", dp_Or_dpp.c_str()),
-                                 1400, 900);
-  cSlices->Divide(nCols, nRows);
-
-  // Graph of mean Δp (or Δp/p) vs momentum-bin center (errors = Gaussian mean errors, unchanged)
-  TGraphErrors* gAll = new TGraphErrors();
-  gAll->SetName(Form("gUnified_%s_%s", thetaBin.c_str(), dp_Or_dpp.c_str()));
-  gAll->SetTitle(Form("FD (all sectors): Mean %s vs Momentum Bin;Momentum Bin Center (GeV/c);Mean %s (GeV/c)",
-                      dp_Or_dpp.c_str(), dp_Or_dpp.c_str()));
-
-  for (size_t bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
-    double p_low = momentum_bins[bin_idx];
-    double p_high = momentum_bins[bin_idx + 1];
-    double p_center = 0.5 * (p_low + p_high);
-
-    // --- Project Y using X-bin indices (excludes under/overflow) ---
-    TAxis* xax = h2->GetXaxis();
-    const int nbx = xax->GetNbins();
-    const double eps = 1e-9;
-
-    // Convert edges to bin indices and clamp to [1, nbx]
-    int ix_lo = xax->FindFixBin(p_low  + eps);
-    int ix_hi = xax->FindFixBin(p_high - eps);
-    ix_lo = std::max(1, std::min(nbx, ix_lo));
-    ix_hi = std::max(1, std::min(nbx, ix_hi));
-
-    // If the range is empty (e.g., both edges beyond xmax), skip this bin
-    if (ix_lo > ix_hi) continue;
-
-    // Now project strictly over valid X bins (no overflow)
-    TH1* hY = h2->ProjectionY(
-        Form("unified_%s_bin%zu", dp_Or_dpp.c_str(), bin_idx + 1),
-        ix_lo, ix_hi
-    );
+  plot_registry().Book({h2}, [=]() mutable {
+    // Momentum-bin edges (same as your sector version)
+    std::vector<double> momentum_bins =
+        (thetaBin == "low")
+            ? std::vector<double>{0.4, 0.6, 0.8, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0, 2.2, 2.4, 2.6, 3.0, 3.2, 3.4, 3.6, 3.8, 4.0, 4.2, 4.4, 4.6, 4.8, 5.0} 
+            : std::vector<double>{0.4, 0.6, 0.8, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0, 2.2, 2.4, 2.6, 2.8, 3.0};
+    const size_t num_bins = momentum_bins.size() - 1;
 
+    // Slices canvas (show all momentum-bin projections)
+    const int nCols = 6;
+    const int nRows = 6; // fits 7–9 bins used here
+    TCanvas* cSlices = new TCanvas(Form("unified_%s_slices", thetaBin.c_str()),
+                                   Form("Unified %s slices (FD, all sectors)", dp_Or_dpp.c_str()),
+                                   1400, 900);
+    cSlices->Divide(nCols, nRows);
 
-    // Style and draw slice
-    cSlices->cd((int)bin_idx + 1);
-    hY->SetTitle(Form("P_{rec} %.2f - %.2f GeV/c; %s; Counts",
-                      p_low, p_high, dp_Or_dpp.c_str()));
-    hY->Draw();
+    // Graph of mean Δp (or Δp/p) vs momentum-bin center (errors = Gaussian mean errors, unchanged)
+    TGraphErrors* gAll = new TGraphErrors();
+    gAll->SetName(Form("gUnified_%s_%s", thetaBin.c_str(), dp_Or_dpp.c_str()));
+    gAll->SetTitle(Form("FD (all sectors): Mean %s vs Momentum Bin;Momentum Bin Center (GeV/c);Mean %s (GeV/c)",
+                        dp_Or_dpp.c_str(), dp_Or_dpp.c_str()));
 
-        // --- Adaptive, momentum-dependent two-step Gaussian fit ---
+    for (size_t bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
+      double p_low = momentum_bins[bin_idx];
+      double p_high = momentum_bins[bin_idx + 1];
+      double p_center = 0.5 * (p_low + p_high);
 
-    // 1) Robust location/scale from the data
-    int imax = hY->GetMaximumBin();
-    double mode = hY->GetBinCenter(imax);
+      // --- Project Y using X-bin indices (excludes under/overflow) ---
+      TAxis* xax = h2->GetXaxis();
+      const int nbx = xax->GetNbins();
+      const double eps = 1e-9;
+
+      // Convert edges to bin indices and clamp to [1, nbx]
+      int ix_lo = xax->FindFixBin(p_low  + eps);
+      int ix_hi = xax->FindFixBin(p_high - eps);
+      ix_lo = std::max(1, std::min(nbx, ix_lo));
+      ix_hi = std::max(1, std::min(nbx, ix_hi));
+
+      // If the range is empty (e.g., both edges beyond xmax), skip this bin
+      if (ix_lo > ix_hi) continue;
+
+      // Now project strictly over valid X bins (no overflow)
+      TH1* hY = h2->ProjectionY(
+          Form("unified_%s_bin%zu", dp_Or_dpp.c_str(), bin_idx + 1),
+          ix_lo, ix_hi
+      );
+
+
+      // Style and draw slice
+      cSlices->cd((int)bin_idx + 1);
+      hY->SetTitle(Form("P_{rec} %.2f - %.2f GeV/c; %s; Counts",
+                        p_low, p_high, dp_Or_dpp.c_str()));
+      hY->Draw();
+
+          // --- Adaptive, momentum-dependent two-step Gaussian fit ---
+
+      // 1) Robust location/scale from the data
+      int imax = hY->GetMaximumBin();
+      double mode = hY->GetBinCenter(imax);
+
+      // central 68% interval → robust sigma
+      Double_t probs[3] = {0.16, 0.50, 0.84}, q[3] = {0,0,0};
+      hY->GetQuantiles(3, q, probs);
+      double sigma68 = 0.5 * (q[2] - q[0]);
+      if (!(sigma68 > 0) || !std::isfinite(sigma68)) {
+        sigma68 = hY->GetRMS();                            // fallback
+        if (!(sigma68 > 0) || !std::isfinite(sigma68))     // ultimate fallback
+          sigma68 = 3.0 * hY->GetBinWidth(1);
+      }
 
-    // central 68% interval → robust sigma
-    Double_t probs[3] = {0.16, 0.50, 0.84}, q[3] = {0,0,0};
-    hY->GetQuantiles(3, q, probs);
-    double sigma68 = 0.5 * (q[2] - q[0]);
-    if (!(sigma68 > 0) || !std::isfinite(sigma68)) {
-      sigma68 = hY->GetRMS();                            // fallback
-      if (!(sigma68 > 0) || !std::isfinite(sigma68))     // ultimate fallback
-        sigma68 = 3.0 * hY->GetBinWidth(1);
-    }
+      // Optionally rebin if the peak is too narrow in bins (stabilizes fit)
+      if (hY->GetEntries() > 0) {
+        double binsPerSigma = sigma68 / hY->GetBinWidth(1);
+        if (binsPerSigma < 6.0 && hY->GetNbinsX() >= 80) hY->Rebin(2);
+      }
 
-    // Optionally rebin if the peak is too narrow in bins (stabilizes fit)
-    if (hY->GetEntries() > 0) {
-      double binsPerSigma = sigma68 / hY->GetBinWidth(1);
-      if (binsPerSigma < 6.0 && hY->GetNbinsX() >= 80) hY->Rebin(2);
-    }
+      // 2) Momentum-dependent opening factor (wider at high p)
+      auto k_init_for_p = [](double p){
+        // 1.3 at low p, grows linearly to 2.3 by p≈4.5, then capped
+        double k = 1.3 + 0.25 * std::max(0.0, std::min( (p - 1.5), 4.0 ));
+        return std::min(2.3, k);
+      };
+      double k1 = k_init_for_p(p_center);
+
+      // Initial fit window around the mode, clamped to axis range
+      double xLo = std::max(hY->GetXaxis()->GetXmin(), mode - k1 * sigma68);
+      double xHi = std::min(hY->GetXaxis()->GetXmax(), mode + k1 * sigma68);
+      if (xLo >= xHi) {                    // robust fallback if something went wrong
+        xLo = mode - 1.5 * sigma68;
+        xHi = mode + 1.5 * sigma68;
+      }
 
-    // 2) Momentum-dependent opening factor (wider at high p)
-    auto k_init_for_p = [](double p){
-      // 1.3 at low p, grows linearly to 2.3 by p≈4.5, then capped
-      double k = 1.3 + 0.25 * std::max(0.0, std::min( (p - 1.5), 4.0 ));
-      return std::min(2.3, k);
-    };
-    double k1 = k_init_for_p(p_center);
-
-    // Initial fit window around the mode, clamped to axis range
-    double xLo = std::max(hY->GetXaxis()->GetXmin(), mode - k1 * sigma68);
-    double xHi = std::min(hY->GetXaxis()->GetXmax(), mode + k1 * sigma68);
-    if (xLo >= xHi) {                    // robust fallback if something went wrong
-      xLo = mode - 1.5 * sigma68;
-      xHi = mode + 1.5 * sigma68;
-    }
+      // Initial fit
+      TF1* fit_init = new TF1(Form("gaus_init_unified_%zu", bin_idx), "gaus", xLo, xHi);
+      hY->Fit(fit_init, "RQ0");
 
-    // Initial fit
-    TF1* fit_init = new TF1(Form("gaus_init_unified_%zu", bin_idx), "gaus", xLo, xHi);
-    hY->Fit(fit_init, "RQ0");
+      // 3) Refine within ±k2·σ around the fitted mean (symmetric)
+      double mu    = fit_init->GetParameter(1);
+      double sigma = std::abs(fit_init->GetParameter(2));
+      if (!(sigma > 0) || !std::isfinite(sigma)) sigma = sigma68;
 
-    // 3) Refine within ±k2·σ around the fitted mean (symmetric)
-    double mu    = fit_init->GetParameter(1);
-    double sigma = std::abs(fit_init->GetParameter(2));
-    if (!(sigma > 0) || !std::isfinite(sigma)) sigma = sigma68;
+      double k2 = 1.25;  // narrower core window for refinement
+      double rLo = std::max(hY->GetXaxis()->GetXmin(), mu - k2 * sigma);
+      double rHi = std::min(hY->GetXaxis()->GetXmax(), mu + k2 * sigma);
+      if (rLo >= rHi) { rLo = mu - 1.2 * sigma; rHi = mu + 1.2 * sigma; }
 
-    double k2 = 1.25;  // narrower core window for refinement
-    double rLo = std::max(hY->GetXaxis()->GetXmin(), mu - k2 * sigma);
-    double rHi = std::min(hY->GetXaxis()->GetXmax(), mu + k2 * sigma);
-    if (rLo >= rHi) { rLo = mu - 1.2 * sigma; rHi = mu + 1.2 * sigma; }
+      TF1* fit_refined = new TF1(Form("gaus_refined_unified_%zu", bin_idx), "gaus", rLo, rHi);
+      hY->Fit(fit_refined, "RQ");
 
-    TF1* fit_refined = new TF1(Form("gaus_refined_unified_%zu", bin_idx), "gaus", rLo, rHi);
-    hY->Fit(fit_refined, "RQ");
+      // Extract and push to the graph
+      double mean     = fit_refined->GetParameter(1);
+      //double mean_err = fit_refined->GetParError(1);
+      double mean_err = 0.001; // uniform error for fitting later
 
-    // Extract and push to the graph
-    double mean     = fit_refined->GetParameter(1);
-    //double mean_err = fit_refined->GetParError(1);
-    double mean_err = 0.001; // uniform error for fitting later
+      int ip = gAll->GetN();
+      gAll->SetPoint(ip, p_center, mean);
+      gAll->SetPointError(ip, 0.0, mean_err);
 
-    int ip = gAll->GetN();
-    gAll->SetPoint(ip, p_center, mean);
-    gAll->SetPointError(ip, 0.0, mean_err);
 
+      // Optional: keep the slice drawn but free the heap objects
+      gPad->Update();         // ensure it is rendered
 
-    // Optional: keep the slice drawn but free the heap objects
-    gPad->Update();         // ensure it is rendered
-       
 
 
-  }
+    }
+
+    cSlices->SaveAs((output_folder + thetaBin +
+                     Form("_theta_%s_UNIFIED_slices.pdf", dp_Or_dpp.c_str())).c_str());
+    delete cSlices;
+
+    // Summary canvas (single panel)
+    TCanvas* cSummary = new TCanvas(Form("unified_%s_summary", thetaBin.c_str()),
+                                    Form("Unified mean %s vs momentum (FD, all sectors)", dp_Or_dpp.c_str()),
+                                    1400, 900);
+    gAll->SetMarkerStyle(20);
+    gAll->SetMarkerSize(1.0);
+    gAll->SetMarkerColor(kBlack);
+    gAll->SetLineColor(kBlack);
+    gAll->Draw("AP");
+    gPad->Update();
+
+    // Autoscale axes from points, but ALWAYS include y=0
+    double xmin_pts = 1e9, xmax_pts = -1e9, ymin_pts = 1e9, ymax_pts = -1e9;
+    for (int k = 0; k < gAll->GetN(); ++k) {
+      double xp, yp; gAll->GetPoint(k, xp, yp);
+      if (!std::isfinite(xp) || !std::isfinite(yp)) continue;
+      xmin_pts = std::min(xmin_pts, xp);
+      xmax_pts = std::max(xmax_pts, xp);
+      ymin_pts = std::min(ymin_pts, yp);
+      ymax_pts = std::max(ymax_pts, yp);
+    }
+    if (xmin_pts < xmax_pts) {
+      double xpad = 0.05 * (xmax_pts - xmin_pts);
+      double xmin_auto = xmin_pts - xpad;
+      double xmax_auto = xmax_pts + xpad;
+
+      ymin_pts = std::min(ymin_pts, 0.0);
+      ymax_pts = std::max(ymax_pts, 0.0);
+      double ypad = 0.10 * std::max(1e-6, ymax_pts - ymin_pts);
+      double ymin_auto = ymin_pts - ypad;
+      double ymax_auto = ymax_pts + ypad;
+
+      gAll->GetXaxis()->SetLimits(xmin_auto, xmax_auto);
+      gAll->GetYaxis()->SetRangeUser(ymin_auto, ymax_auto);
+      if (TH1* fr = gAll->GetHistogram()) {
+        fr->GetXaxis()->SetLimits(xmin_auto, xmax_auto);
+        fr->SetMinimum(ymin_auto);
+        fr->SetMaximum(ymax_auto);
+      }
+      gPad->Update();
+    }
+
+    gPad->SetGrid();
+
+    // Fit range (independent from axis display)
+    double xmin_fit = 0.25, xmax_fit = 3.0;
+    if(thetaBin=="low"){  xmin_fit = 0.25, xmax_fit = 2.0;}
+
 
-  cSlices->SaveAs((output_folder + thetaBin +
-                   Form("_theta_%s_UNIFIED_slices.pdf", dp_Or_dpp.c_str())).c_str());
-  delete cSlices;
-
-  // Summary canvas (single panel)
-  TCanvas* cSummary = new TCanvas(Form("unified_%s_summary", thetaBin.c_str()),
-                                  Form("Unified mean %s vs momentum (FD, all sectors)", dp_Or_dpp.c_str()),
-                                  1400, 900);
-  gAll->SetMarkerStyle(20);
-  gAll->SetMarkerSize(1.0);
-  gAll->SetMarkerColor(kBlack);
-  gAll->SetLineColor(kBlack);
-  gAll->Draw("AP");
-  gPad->Update();
-
-  // Autoscale axes from points, but ALWAYS include y=0
-  double xmin_pts = 1e9, xmax_pts = -1e9, ymin_pts = 1e9, ymax_pts = -1e9;
+  // --- Fit unified data with f(p) = A/(B + C*sqrt(p) + D*p + E*p^2) ---
+  // Use only points inside [xmin_fit, xmax_fit] for endpoint-based seeds
+  double pmin = 1e9, pmax = -1e9, pL = 0, yL = 0, pR = 0, yR = 0;
   for (int k = 0; k < gAll->GetN(); ++k) {
     double xp, yp; gAll->GetPoint(k, xp, yp);
     if (!std::isfinite(xp) || !std::isfinite(yp)) continue;
-    xmin_pts = std::min(xmin_pts, xp);
-    xmax_pts = std::max(xmax_pts, xp);
-    ymin_pts = std::min(ymin_pts, yp);
-    ymax_pts = std::max(ymax_pts, yp);
+    if (xp < xmin_fit || xp > xmax_fit) continue; // restrict to fit window
+    if (xp < pmin) { pmin = xp; pL = xp; yL = yp; }
+    if (xp > pmax) { pmax = xp; pR = xp; yR = yp; }
   }
-  if (xmin_pts < xmax_pts) {
-    double xpad = 0.05 * (xmax_pts - xmin_pts);
-    double xmin_auto = xmin_pts - xpad;
-    double xmax_auto = xmax_pts + xpad;
-
-    ymin_pts = std::min(ymin_pts, 0.0);
-    ymax_pts = std::max(ymax_pts, 0.0);
-    double ypad = 0.10 * std::max(1e-6, ymax_pts - ymin_pts);
-    double ymin_auto = ymin_pts - ypad;
-    double ymax_auto = ymax_pts + ypad;
-
-    gAll->GetXaxis()->SetLimits(xmin_auto, xmax_auto);
-    gAll->GetYaxis()->SetRangeUser(ymin_auto, ymax_auto);
-    if (TH1* fr = gAll->GetHistogram()) {
-      fr->GetXaxis()->SetLimits(xmin_auto, xmax_auto);
-      fr->SetMinimum(ymin_auto);
-      fr->SetMaximum(ymax_auto);
-    }
-    gPad->Update();
+
+  // A ≈ p*y at high p (same heuristic as before)
+  double A0 = (std::isfinite(pR * yR) ? pR * yR : -1e-2);
+  if (!std::isfinite(A0)) A0 = -1e-2;
+
+  // From old y ~ A/(p+B) seed, reuse B0; C0,D0,E0 start simple
+  auto seedB = [&](double p, double y) {
+    return (std::abs(y) > 1e-12) ? (A0 / y - p) : (-p + 0.05);
+  };
+  double B0 = 0.5 * (seedB(pL, yL) + seedB(pR, yR));
+  if (!std::isfinite(B0)) B0 = 0.1;  // fallback
+
+  double C0 = 0.0;   // let fitter find small sqrt(p) piece
+  double D0 = 1.0;   // keeps continuity with old A/(p+B) ~ A/(B + 1*p)
+  double E0 = 0.0;   // start without p^2 term, add in second stage
+
+  // Conservative bounds to help keep denominator > 0 over the window
+  const double eps = 1e-3;
+  double Bmin = eps,  Bmax = 20.0;
+  double Cmin = -5.0, Cmax =  5.0;
+  double Dmin =  0.0, Dmax =  5.0;
+  double Emin =  0.0, Emax =  5.0;
+
+  // Build function
+  TF1* fitFunc = new TF1("fit_unified_ABCDsqE",
+      "[0]/([1] + [2]*sqrt(x) + [3]*x + [4]*x*x)", xmin_fit, xmax_fit);
+  fitFunc->SetParNames("A","B","C","D","E");
+  fitFunc->SetParameters(A0, B0, C0, D0, E0);
+  fitFunc->SetParLimits(1, Bmin, Bmax);
+  fitFunc->SetParLimits(2, Cmin, Cmax);
+  fitFunc->SetParLimits(3, Dmin, Dmax);
+  fitFunc->SetParLimits(4, Emin, Emax);
+
+  // ---- Stage 1: stabilize (fix E=0), then fit in the chosen range
+  fitFunc->FixParameter(4, 0.0);
+  gAll->Fit(fitFunc, "RQ");   // "R" = use [xmin_fit, xmax_fit]; "Q" = quiet
+
+  // ---- Stage 2: release E and refit
+  fitFunc->ReleaseParameter(4);
+  gAll->Fit(fitFunc, "RQ");
+
+  // Draw and annotate
+  fitFunc->SetLineColor(kBlue);
+  fitFunc->SetLineStyle(1);
+  fitFunc->Draw("SAME");
+
+  double A = fitFunc->GetParameter(0);
+  double B = fitFunc->GetParameter(1);
+  double C = fitFunc->GetParameter(2);
+  double D = fitFunc->GetParameter(3);
+  double E = fitFunc->GetParameter(4);
+
+  double eA = fitFunc->GetParError(0);
+  double eB = fitFunc->GetParError(1);
+  double eC = fitFunc->GetParError(2);
+  double eD = fitFunc->GetParError(3);
+  double eE = fitFunc->GetParError(4);
+
+  double chi2 = fitFunc->GetChisquare();
+  int    ndf  = fitFunc->GetNDF();
+
+  // with ANALYSIS_PRINT_FITS set (bench_convert.sh precision), one greppable line per fit
+  if (std::getenv("ANALYSIS_PRINT_FITS")) {
+    std::cout << "[fit] unified_" << thetaBin << "_" << dp_Or_dpp
+              << Form(" A=%.6e B=%.6e C=%.6e D=%.6e E=%.6e", A, B, C, D, E)
+              << Form(" eA=%.6e eB=%.6e eC=%.6e eD=%.6e eE=%.6e", eA, eB, eC, eD, eE)
+              << Form(" chi2=%.4f ndf=%d", chi2, ndf) << std::endl;
   }
 
-  gPad->SetGrid();
+  TLatex latex;
+  latex.SetTextFont(42);
+  latex.SetTextSize(0.038);
+  latex.SetNDC();
+  latex.DrawLatex(0.55, 0.36, Form("A = %.3e #pm %.1e", A, eA));
+  latex.DrawLatex(0.55, 0.32, Form("B = %.3e #pm %.1e", B, eB));
+  latex.DrawLatex(0.55, 0.28, Form("C = %.3e #pm %.1e", C, eC));
+  latex.DrawLatex(0.55, 0.24, Form("D = %.3e #pm %.1e", D, eD));
+  latex.DrawLatex(0.55, 0.20, Form("E = %.3e #pm %.1e", E, eE));
+  latex.DrawLatex(0.55, 0.16, Form("#chi^{2}/NDF = %.1f / %d = %.2f",
+                                   chi2, ndf, chi2 / ndf));
 
-  // Fit range (independent from axis display)
-  double xmin_fit = 0.25, xmax_fit = 3.0;
-  if(thetaBin=="low"){  xmin_fit = 0.25, xmax_fit = 2.0;}
 
 
-// --- Fit unified data with f(p) = A/(B + C*sqrt(p) + D*p + E*p^2) ---
-// Use only points inside [xmin_fit, xmax_fit] for endpoint-based seeds
-double pmin = 1e9, pmax = -1e9, pL = 0, yL = 0, pR = 0, yR = 0;
-for (int k = 0; k < gAll->GetN(); ++k) {
-  double xp, yp; gAll->GetPoint(k, xp, yp);
-  if (!std::isfinite(xp) || !std::isfinite(yp)) continue;
-  if (xp < xmin_fit || xp > xmax_fit) continue; // restrict to fit window
-  if (xp < pmin) { pmin = xp; pL = xp; yL = yp; }
-  if (xp > pmax) { pmax = xp; pR = xp; yR = yp; }
-}
-
-// A ≈ p*y at high p (same heuristic as before)
-double A0 = (std::isfinite(pR * yR) ? pR * yR : -1e-2);
-if (!std::isfinite(A0)) A0 = -1e-2;
+    // Draw y=0 reference line across the current X range
+    double xlo = gAll->GetXaxis()->GetXmin();
+    double xhi = gAll->GetXaxis()->GetXmax();
+    TLine* zeroLine = new TLine(xlo, 0.0, xhi, 0.0);
+    zeroLine->SetLineColor(kRed);
+    zeroLine->SetLineStyle(2);
+    zeroLine->SetLineWidth(2);
+    zeroLine->Draw("SAME");
 
-// From old y ~ A/(p+B) seed, reuse B0; C0,D0,E0 start simple
-auto seedB = [&](double p, double y) {
-  return (std::abs(y) > 1e-12) ? (A0 / y - p) : (-p + 0.05);
-};
-double B0 = 0.5 * (seedB(pL, yL) + seedB(pR, yR));
-if (!std::isfinite(B0)) B0 = 0.1;  // fallback
-
-double C0 = 0.0;   // let fitter find small sqrt(p) piece
-double D0 = 1.0;   // keeps continuity with old A/(p+B) ~ A/(B + 1*p)
-double E0 = 0.0;   // start without p^2 term, add in second stage
-
-// Conservative bounds to help keep denominator > 0 over the window
-const double eps = 1e-3;
-double Bmin = eps,  Bmax = 20.0;
-double Cmin = -5.0, Cmax =  5.0;
-double Dmin =  0.0, Dmax =  5.0;
-double Emin =  0.0, Emax =  5.0;
-
-// Build function
-TF1* fitFunc = new TF1("fit_unified_ABCDsqE",
-    "[0]/([1] + [2]*sqrt(x) + [3]*x + [4]*x*x)", xmin_fit, xmax_fit);
-fitFunc->SetParNames("A","B","C","D","E");
-fitFunc->SetParameters(A0, B0, C0, D0, E0);
-fitFunc->SetParLimits(1, Bmin, Bmax);
-fitFunc->SetParLimits(2, Cmin, Cmax);
-fitFunc->SetParLimits(3, Dmin, Dmax);
-fitFunc->SetParLimits(4, Emin, Emax);
-
-// ---- Stage 1: stabilize (fix E=0), then fit in the chosen range
-fitFunc->FixParameter(4, 0.0);
-gAll->Fit(fitFunc, "RQ");   // "R" = use [xmin_fit, xmax_fit]; "Q" = quiet
-
-// ---- Stage 2: release E and refit
-fitFunc->ReleaseParameter(4);
-gAll->Fit(fitFunc, "RQ");
-
-// Draw and annotate
-fitFunc->SetLineColor(kBlue);
-fitFunc->SetLineStyle(1);
-fitFunc->Draw("SAME");
-
-double A = fitFunc->GetParameter(0);
-double B = fitFunc->GetParameter(1);
-double C = fitFunc->GetParameter(2);
-double D = fitFunc->GetParameter(3);
-double E = fitFunc->GetParameter(4);
-
-double eA = fitFunc->GetParError(0);
-double eB = fitFunc->GetParError(1);
-double eC = fitFunc->GetParError(2);
-double eD = fitFunc->GetParError(3);
-double eE = fitFunc->GetParError(4);
-
-double chi2 = fitFunc->GetChisquare();
-int    ndf  = fitFunc->GetNDF();
-
-TLatex latex;
-latex.SetTextFont(42);
-latex.SetTextSize(0.038);
-latex.SetNDC();
-latex.DrawLatex(0.55, 0.36, Form("A = %.3e #pm %.1e", A, eA));
-latex.DrawLatex(0.55, 0.32, Form("B = %.3e #pm %.1e", B, eB));
-latex.DrawLatex(0.55, 0.28, Form("C = %.3e #pm %.1e", C, eC));
-latex.DrawLatex(0.55, 0.24, Form("D = %.3e #pm %.1e", D, eD));
-latex.DrawLatex(0.55, 0.20, Form("E = %.3e #pm %.1e", E, eE));
-latex.DrawLatex(0.55, 0.16, Form("#chi^{2}/NDF = %.1f / %d = %.2f",
-                                 chi2, ndf, chi2 / ndf));
-
-
-
-  // Draw y=0 reference line across the current X range
-  double xlo = gAll->GetXaxis()->GetXmin();
-  double xhi = gAll->GetXaxis()->GetXmax();
-  TLine* zeroLine = new TLine(xlo, 0.0, xhi, 0.0);
-  zeroLine->SetLineColor(kRed);
-  zeroLine->SetLineStyle(2);
-  zeroLine->SetLineWidth(2);
-  zeroLine->Draw("SAME");
-
-  cSummary->SaveAs((output_folder + thetaBin +
-                    "_theta_mean_" + dp_Or_dpp +
-                    "_vs_momentum_bin_UNIFIED.pdf").c_str());
-  delete cSummary;
+    cSummary->SaveAs((output_folder + thetaBin +
+                      "_theta_mean_" + dp_Or_dpp +
+                      "_vs_momentum_bin_UNIFIED.pdf").c_str());
+    delete cSummary;
+  });
 }
 
 
@@ -1002,7 +1026,7 @@ latex.DrawLatex(0.55, 0.16, Form("#chi^{2}/NDF = %.1f / %d = %.2f",
 
 
 void plot_theta_slices_2D(ROOT::RDF::RNode rdf, const std::string& output_folder) { // needs to theta vs delta p instead of theta vs p. define momentum bining
-    auto rdf_theta = rdf.Filter("detector == \"FD\" && Theta_rec >= 28 && Theta_rec < 30");
+    auto rdf_theta = rdf.Filter("is_FD && Theta_rec >= 28 && Theta_rec < 30");
 
     std::vector<std::pair<double, double>> p_bins = {
         {0.4, 0.5},
@@ -1014,44 +1038,49 @@ void plot_theta_slices_2D(ROOT::RDF::RNode rdf, const std::string& output_folder
         auto rdf_p = rdf_theta.Filter(Form("p_proton_rec >= %.3f && p_proton_rec <= %.3f", p_min, p_max));
 
         auto h_dp_vs_p = rdf_p.Histo2D(
-            {"h_dp_vs_p", Form("delta_p vs p_rec [Theta 28 - 30, %s];p_rec (GeV/c);delta_p (GeV/c)", label.c_str()),
+            {("h_dp_vs_p_" + label).c_str(), Form("delta_p vs p_rec [Theta 28 - 30, %s];p_rec (GeV/c);delta_p (GeV/c)", label.c_str()),
              100, 0, 2.5, 100, -0.1, 0.1},
             "p_proton_rec", "delta_p");
 
         auto h_theta_vs_p = rdf_p.Histo2D(
-            {"h_theta_vs_p", Form("Theta_rec vs p_rec [Theta 28 - 30, %s];p_rec (GeV/c);Theta_rec (deg)", label.c_str()),
+            {("h_theta_vs_p_" + label).c_str(), Form("Theta_rec vs p_rec [Theta 28 - 30, %s];p_rec (GeV/c);Theta_rec (deg)", label.c_str()),
              100, 0, 2.5, 100, 0, 60},
             "p_proton_rec", "Theta_rec");
 
         auto h_theta_vs_dpnorm = rdf_p.Histo2D(
-            {"h_theta_vs_dpnorm", Form("Theta_rec vs delta_p/p [Theta 28 - 30, %s];delta_p/p;Theta_rec (deg)", label.c_str()),
+            {("h_theta_vs_dpnorm_" + label).c_str(), Form("Theta_rec vs delta_p/p [Theta 28 - 30, %s];delta_p/p;Theta_rec (deg)", label.c_str()),
              100, -0.2, 0.1, 100, 0, 60},
             "dp_norm", "Theta_rec");
 
-        TCanvas* c1 = new TCanvas(Form("canvas_dp_vs_p_%s", label.c_str()), "delta_p vs p", 800, 600);
-        h_dp_vs_p->Draw("COLZ");
-        c1->SaveAs((output_folder + "delta_p_vs_p_" + label + ".pdf").c_str());
-        delete c1;
-
-        TCanvas* c2 = new TCanvas(Form("canvas_theta_vs_p_%s", label.c_str()), "Theta vs p", 800, 600);
-        h_theta_vs_p->Draw("COLZ");
-        c2->SaveAs((output_folder + "theta_vs_p_" + label + ".pdf").c_str());
-        delete c2;
-
-        TCanvas* c3 = new TCanvas(Form("canvas_theta_vs_dpnorm_%s", label.c_str()), "Theta vs delta_p/p", 800, 600);
-        h_theta_vs_dpnorm->Draw("COLZ");
-        c3->SaveAs((output_folder + "theta_vs_dpnorm_" + label + ".pdf").c_str());
-        delete c3;
+        plot_registry().Book({h_dp_vs_p, h_theta_vs_p, h_theta_vs_dpnorm}, [=]() mutable {
+            TCanvas* c1 = new TCanvas(Form("canvas_dp_vs_p_%s", label.c_str()), "delta_p vs p", 800, 600);
+            h_dp_vs_p->Draw("COLZ");
+            c1->SaveAs((output_folder + "delta_p_vs_p_" + label + ".pdf").c_str());
+            delete c1;
+
+            TCanvas* c2 = new TCanvas(Form("canvas_theta_vs_p_%s", label.c_str()), "Theta vs p", 800, 600);
+            h_theta_vs_p->Draw("COLZ");
+            c2->SaveAs((output_folder + "theta_vs_p_" + label + ".pdf").c_str());
+            delete c2;
+
+            TCanvas* c3 = new TCanvas(Form("canvas_theta_vs_dpnorm_%s", label.c_str()), "Theta vs delta_p/p", 800, 600);
+            h_theta_vs_dpnorm->Draw("COLZ");
+            c3->SaveAs((output_folder + "theta_vs_dpnorm_" + label + ".pdf").c_str());
+            delete c3;
+        });
     }
 
-    std::cout << "Saved 2D plots for Theta_rec  and selected p_rec bins.\n";
+    // after the last p bin is drawn
+    plot_registry().Book({}, [] {
+        std::cout << "Saved 2D plots for Theta_rec  and selected p_rec bins.\n";
+    });
 }
 
 
 
 void delta_P_VS_P_rec_CD_1D(ROOT::RDF::RNode rdf, const std::string& output_folder) {
     // Filter for Central Detector (CD)
-    auto rdf_filtered = rdf.Filter("detector == \"CD\"");
+    auto rdf_filtered = rdf.Filter("is_CD");
 
     // Create 2D histogram: X = p_proton_rec, Y = delta_p
     auto hist2D = rdf_filtered.Histo2D(
@@ -1062,79 +1091,81 @@ void delta_P_VS_P_rec_CD_1D(ROOT::RDF::RNode rdf, const std::string& output_fold
         "p_proton_rec", "delta_p"
     );
 
-    // Fine momentum binning from 0.25 to 1.25 in steps of 0.1
-    std::vector<double> momentum_bins;
-    for (double p = 0.25; p <= 1.25 + 1e-6; p += 0.1) {
-        momentum_bins.push_back(p);
-    }
-    const size_t num_bins = momentum_bins.size() - 1;
+    plot_registry().Book({hist2D}, [=]() mutable {
+        // Fine momentum binning from 0.25 to 1.25 in steps of 0.1
+        std::vector<double> momentum_bins;
+        for (double p = 0.25; p <= 1.25 + 1e-6; p += 0.1) {
+            momentum_bins.push_back(p);
+        }
+        const size_t num_bins = momentum_bins.size() - 1;
 
-    // Create canvas for 1D plots
-    size_t nCols = 4;
-    size_t nRows = (num_bins + nCols - 1) / nCols;
-    TCanvas* c = new TCanvas("cd_canvas", "Central Detector Δp in Momentum Bins", 300 * nCols, 300 * nRows);
-    c->Divide(nCols, nRows);
+        // Create canvas for 1D plots
+        size_t nCols = 4;
+        size_t nRows = (num_bins + nCols - 1) / nCols;
+        TCanvas* c = new TCanvas("cd_canvas", "Central Detector Δp in Momentum Bins", 300 * nCols, 300 * nRows);
+        c->Divide(nCols, nRows);
 
-    // Prepare graph for mean vs momentum bin center
-    TGraphErrors* gCD = new TGraphErrors();
-    gCD->SetName("gCD");
-    gCD->SetTitle("Central Detector: Mean Δp vs Momentum Bin;Momentum Bin Center (GeV);Mean Δp (GeV)");
+        // Prepare graph for mean vs momentum bin center
+        TGraphErrors* gCD = new TGraphErrors();
+        gCD->SetName("gCD");
+        gCD->SetTitle("Central Detector: Mean Δp vs Momentum Bin;Momentum Bin Center (GeV);Mean Δp (GeV)");
 
-    for (size_t bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
-        double p_low = momentum_bins[bin_idx];
-        double p_high = momentum_bins[bin_idx + 1];
-        double p_center = 0.5 * (p_low + p_high);
+        for (size_t bin_idx = 0; bin_idx < num_bins; ++bin_idx) {
+            double p_low = momentum_bins[bin_idx];
+            double p_high = momentum_bins[bin_idx + 1];
+            double p_center = 0.5 * (p_low + p_high);
 
-        hist2D->GetXaxis()->SetRangeUser(p_low, p_high);
+            hist2D->GetXaxis()->SetRangeUser(p_low, p_high);
 
-        TH1* hist1D = hist2D->ProjectionY(Form("delta_p_bin%zu", bin_idx + 1));
-        hist1D->SetTitle(Form("CD: %.2f - %.2f GeV;delta P (GeV);Counts", p_low, p_high));
+            TH1* hist1D = hist2D->ProjectionY(Form("delta_p_bin%zu", bin_idx + 1));
+            hist1D->SetTitle(Form("CD: %.2f - %.2f GeV;delta P (GeV);Counts", p_low, p_high));
 
-        c->cd(bin_idx + 1);
-        hist1D->Draw();
+            c->cd(bin_idx + 1);
+            hist1D->Draw();
 
-        // First rough fit
-        TF1* rough_fit = new TF1("rough_fit", "gaus", -0.1, 0.1);
-        hist1D->Fit(rough_fit, "RQ0");  // Q0 = quiet and no draw
+            // First rough fit
+            TF1* rough_fit = new TF1("rough_fit", "gaus", -0.1, 0.1);
+            hist1D->Fit(rough_fit, "RQ0");  // Q0 = quiet and no draw
 
-        double mean = rough_fit->GetParameter(1);
-        double sigma = rough_fit->GetParameter(2);
+            double mean = rough_fit->GetParameter(1);
+            double sigma = rough_fit->GetParameter(2);
 
-        // Refined fit in [mean - sigma, mean + sigma]
-        TF1* refined_fit = new TF1("refined_fit", "gaus", mean - sigma, mean + sigma);
-        hist1D->Fit(refined_fit, "RQ");
+            // Refined fit in [mean - sigma, mean + sigma]
+            TF1* refined_fit = new TF1("refined_fit", "gaus", mean - sigma, mean + sigma);
+            hist1D->Fit(refined_fit, "RQ");
 
-        double refined_mean = refined_fit->GetParameter(1);
-        double refined_sigma = refined_fit->GetParameter(2);
+            double refined_mean = refined_fit->GetParameter(1);
+            double refined_sigma = refined_fit->GetParameter(2);
 
-        gCD->SetPoint(bin_idx, p_center, refined_mean);
-        gCD->SetPointError(bin_idx, 0.0, refined_sigma);
-    }
+            gCD->SetPoint(bin_idx, p_center, refined_mean);
+            gCD->SetPointError(bin_idx, 0.0, refined_sigma);
+        }
 
-    c->SaveAs((output_folder + "delta_p_CD_bins_fine.pdf").c_str());
-    delete c;
+        c->SaveAs((output_folder + "delta_p_CD_bins_fine.pdf").c_str());
+        delete c;
 
-    // === Summary plot ===
-    TCanvas* summaryCanvas = new TCanvas("summaryCanvas_CD", "CD Mean Δp vs Momentum Bin (fine bins)", 800, 600);
-    summaryCanvas->cd();
+        // === Summary plot ===
+        TCanvas* summaryCanvas = new TCanvas("summaryCanvas_CD", "CD Mean Δp vs Momentum Bin (fine bins)", 800, 600);
+        summaryCanvas->cd();
 
-    gCD->SetMarkerStyle(20);
-    gCD->SetMarkerColor(kBlack);
-    gCD->SetLineColor(kBlack);
-    gCD->Draw("AP");
-    gCD->GetXaxis()->SetLimits(0.2, 1.25);  // <-- Add this line to set X-axis range
-    gPad->SetGrid();
+        gCD->SetMarkerStyle(20);
+        gCD->SetMarkerColor(kBlack);
+        gCD->SetLineColor(kBlack);
+        gCD->Draw("AP");
+        gCD->GetXaxis()->SetLimits(0.2, 1.25);  // <-- Add this line to set X-axis range
+        gPad->SetGrid();
 
-    // Red horizontal line at y = 0
-    TLine* zeroLine = new TLine(0.25, 0.0, 1.25, 0.0);
-    zeroLine->SetLineColor(kRed);
-    zeroLine->SetLineStyle(2);
-    zeroLine->SetLineWidth(2);
-    zeroLine->Draw("SAME");
+        // Red horizontal line at y = 0
+        TLine* zeroLine = new TLine(0.25, 0.0, 1.25, 0.0);
+        zeroLine->SetLineColor(kRed);
+        zeroLine->SetLineStyle(2);
+        zeroLine->SetLineWidth(2);
+        zeroLine->Draw("SAME");
 
-    summaryCanvas->SaveAs((output_folder + "mean_delta_p_vs_momentum_bin_CD_fine.pdf").c_str());
+        summaryCanvas->SaveAs((output_folder + "mean_delta_p_vs_momentum_bin_CD_fine.pdf").c_str());
 
-    std::cout << "Saved fine-binned central detector Δp plots and summary with fit mean/sigma.\n";
+        std::cout << "Saved fine-binned central detector Δp plots and summary with fit mean/sigma.\n";
+    });
 }
 
 //------------------------------------------------------------------------------------------------------------------------///
@@ -1142,38 +1173,40 @@ void delta_P_VS_P_rec_CD_1D(ROOT::RDF::RNode rdf, const std::string& output_fold
 void plot_XY_DC1(ROOT::RDF::RNode rdf, const std::string& output_folder) {
     // Filter out invalid points (default -1000 values)
     auto rdf_filtered = rdf.Filter("x1_proton > -999 && y1_proton > -999 && x1_electron > -999 && y1_electron > -999");
-    //rdf_filtered = rdf_filtered.Filter("detector == \"FD\" && DC_fiducial_cut_proton == true && DC_fiducial_cut_electron == true");
+    //rdf_filtered = rdf_filtered.Filter("is_FD && DC_fiducial_cut_proton == true && DC_fiducial_cut_electron == true");
 
-    TCanvas canvas("cXY", "DC1 X vs Y", 3000, 1000);
-    canvas.Divide(2, 1);
-
-    canvas.cd(1);
     auto hist_e = rdf_filtered.Histo2D(
         ROOT::RDF::TH2DModel("XY_electron", "DC1 X vs Y - Electron; X (cm); Y (cm)", 100, -200, 200, 100, -200, 200),
         "x1_electron", "y1_electron"
     );
-    hist_e->SetStats(true);
-    hist_e->Draw("COLZ");
-
-    canvas.cd(2);
     auto hist_p = rdf_filtered.Histo2D(
         ROOT::RDF::TH2DModel("XY_proton", "DC1 X vs Y - Proton; X (cm); Y (cm)", 100, -200, 200, 100, -200, 200),
         "x1_proton", "y1_proton"
     );
-    hist_p->SetStats(true);
-    hist_p->Draw("COLZ");
 
-    canvas.SaveAs((output_folder + "XY_DC1_proton_vs_electron_NO_Fid_Cuts.pdf").c_str());
-    std::cout << "Saved 2D plot XY_DC1_proton_vs_electron.pdf" << std::endl;
-}
+    plot_registry().Book({hist_e, hist_p}, [=]() mutable {
+        TCanvas canvas("cXY", "DC1 X vs Y", 3000, 1000);
+        canvas.Divide(2, 1);
 
-void Theta_proton_DC_VS_momentum_FD(ROOT::RDF::RNode rdf, const std::string& output_folder) {
-    TCanvas canvas("c8", "Theta_DC VS momentum FD proton ", 800, 600);
-    auto hist1 = rdf.Filter("detector == \"FD\" && DC_fiducial_cut_electron ==true && DC_fiducial_cut_proton == true").Histo2D(ROOT::RDF::TH2DModel("Theta_DC_VS_P_rec_FD", "Theta_DC VS P_rec in FD proton; P_rec (GeV); Theta_DC (deg)", 100, 0, 2.5, 100, 0, 40),  "p_proton_rec", "Theta_proton_DC" );
-    hist1->Draw("COLZ");
-    canvas.SaveAs((output_folder + "Theta_DC_VS_momentum_FD_CD.pdf").c_str());
-    std::cout << "Saved 2D histogram as Theta_DC_VS_momentum_FD_CD.pdf" << std::endl;
-}
+        canvas.cd(1);
+        hist_e->SetStats(true);
+        hist_e->Draw("COLZ");
 
+        canvas.cd(2);
+        hist_p->SetStats(true);
+        hist_p->Draw("COLZ");
 
+        canvas.SaveAs((output_folder + "XY_DC1_proton_vs_electron_NO_Fid_Cuts.pdf").c_str());
+        std::cout << "Saved 2D plot XY_DC1_proton_vs_electron.pdf" << std::endl;
+    });
+}
 
+void Theta_proton_DC_VS_momentum_FD(ROOT::RDF::RNode rdf, const std::string& output_folder) {
+    auto hist1 = rdf.Filter("is_FD && DC_fiducial_cut_electron ==true && DC_fiducial_cut_proton == true").Histo2D(ROOT::RDF::TH2DModel("Theta_DC_VS_P_rec_FD", "Theta_DC VS P_rec in FD proton; P_rec (GeV); Theta_DC (deg)", 100, 0, 2.5, 100, 0, 40),  "p_proton_rec", "Theta_proton_DC" );
+    plot_registry().Book({hist1}, [=]() mutable {
+        TCanvas canvas("c8", "Theta_DC VS momentum FD proton ", 800, 600);
+        hist1->Draw("COLZ");
+        canvas.SaveAs((output_folder + "Theta_DC_VS_momentum_FD_CD.pdf").c_str());
+        std::cout << "Saved 2D histogram as Theta_DC_VS_momentum_FD_CD.pdf" << std::endl;
+    });
+}
@@ -1,4 +1,6 @@
 #!/bin/bash
+# Stages everything, then exits. To convert runs while the rest are still
+# being staged, use stage_and_convert.py instead.
 
 # --------------------------
 # Configuration
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Stage runs from tape and convert each one as soon as it lands in /cache.
+
+get_from_tape.sh stages everything first and conversion starts afterwards.
+This driver overlaps the two:
+
+  * staging requests go out in batches (`--batch` files per `jcache get`),
+    at most `--max-pending` files in flight;
+  * the cache path of every requested file (the same mss -> cache mapping
+    as get_from_tape.sh) is polled, and a file counts as ready once its size
+    has not changed between two polls;
+  * ready files go to `--workers` converter processes, `--files-per-job` at a
+    time, each writing <out-dir>/<first run>.root via hipo2root.c.
+
+Files already converted (listed in <out-dir>/converted.txt) are skipped on a
+re-run, so an interrupted session just continues.
+
+    ./stage_and_convert.py runs_on_tape.txt --out-dir /volatile/.../root --workers 8 -- --threads=2
+
+Local test without tape, with a copy standing in for jcache:
+
+    ./stage_and_convert.py list.txt --out-dir out --mss-prefix /tmp/tape --cache-prefix /tmp/cache \\
+        --stage-cmd 'bash -c "for f; do sleep 1; mkdir -p $(dirname ${f/tape/cache}); cp $f ${f/tape/cache}; done" stage'
+"""
+import argparse
+import os
+import shlex
+import subprocess
+import sys
+import time
+from concurrent.futures import FIRST_COMPLETED, ThreadPoolExecutor, wait
+
+HIPO2ROOT_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "hipo2root")
+
+
+def cache_path(mss_file, mss_prefix, cache_prefix):
+    """Same mapping as get_from_tape.sh: the first `mss_prefix` becomes `cache_prefix`."""
+    return mss_file.replace(mss_prefix, cache_prefix, 1)
+
+
+def stage(cmd, files, log):
+    """Start one staging request for `files`; jcache returns once the request is queued."""
+    try:
+        return subprocess.Popen(shlex.split(cmd) + files, stdout=log, stderr=subprocess.STDOUT)
+    except OSError as e:
+        sys.exit(f"ERROR: cannot run staging command '{cmd}': {e}")
+
+
+def convert(files, out_dir, extra, tag):
+    """Convert `files` into one ROOT file; returns (files, ok, seconds)."""
+    lst = os.path.join(out_dir, f"{tag}.dat")
+    out = os.path.join(out_dir, f"{tag}.root")
+    with open(lst, "w") as f:
+        f.writelines(p + "\n" for p in files)
+    cmd = ["clas12root", "-q", "-b", "hipo2root.c", f"--in={lst}", f"--out={out}"] + extra
+    t0 = time.time()
+    with open(os.path.join(out_dir, f"{tag}.log"), "w") as log:
+        rc = subprocess.call(cmd, cwd=HIPO2ROOT_DIR, stdout=log, stderr=subprocess.STDOUT)
+    ok = rc == 0 and os.path.isfile(out + ".report.json")
+    return files, ok, time.time() - t0
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    p.add_argument("input", help="file with full /mss/... paths, one per line")
+    p.add_argument("--out-dir", required=True)
+    p.add_argument("--stage-cmd", default="jcache get", help="staging command, the files are appended")
+    p.add_argument("--mss-prefix", default="mss")
+    p.add_argument("--cache-prefix", default="cache")
+    p.add_argument("--batch", type=int, default=50, help="files per staging request")
+    p.add_argument("--max-pending", type=int, default=500, help="files requested but not yet in cache")
+    p.add_argument("--workers", type=int, default=4, help="converter processes")
+    p.add_argument("--files-per-job", type=int, default=1, help="ready files per converter run")
+    p.add_argument("--poll", type=float, default=30., help="seconds between cache checks")
+    p.add_argument("--timeout", type=float, default=24 * 3600., help="give up on a file after this many seconds")
+
+    # everything after "--" is passed to hipo2root unchanged
+    argv = sys.argv[1:]
+    extra = argv[argv.index("--") + 1:] if "--" in argv else []
+    a = p.parse_args(argv[:argv.index("--")] if "--" in argv else argv)
+
+    os.makedirs(a.out_dir, exist_ok=True)
+    a.out_dir = os.path.abspath(a.out_dir)
+    done_path = os.path.join(a.out_dir, "converted.txt")
+    done = set()
+    if os.path.isfile(done_path):
+        with open(done_path) as f:
+            done = {l.strip() for l in f if l.strip()}
+
+    with open(a.input) as f:
+        todo = [l.strip() for l in f if l.strip() and l.strip() not in done]
+    print(f"{len(todo)} files to stage and convert ({len(done)} already converted)")
+
+    log = open(os.path.join(a.out_dir, "staging.log"), "a")
+    requests = []            # running staging processes and their files
+    pending = {}             # mss path -> [cache path, request time, last size]
+    ready = []               # cache complete, waiting for a converter
+    running = set()
+    failed = []
+    jobs = 0
+    t0 = time.time()
+
+    with ThreadPoolExecutor(max_workers=a.workers) as pool, open(done_path, "a") as done_file:
+        while todo or pending or ready or running:
+            # --- staging requests, in batches, while under the in-flight limit
+            while todo and len(pending) + a.batch <= max(a.batch, a.max_pending):
+                batch, todo = todo[:a.batch], todo[a.batch:]
+                for mss in batch:
+                    pending[mss] = [cache_path(mss, a.mss_prefix, a.cache_prefix), time.time(), -1]
+                missing = [m for m in batch if not os.path.isfile(pending[m][0])]
+                if missing:
+                    requests.append((stage(a.stage_cmd, missing, log), missing))
+
+            # a failed request gives up on its files that have not shown up
+            for proc, files in [r for r in requests if r[0].poll() not in (None, 0)]:
+                lost = [m for m in files if m in pending and not os.path.isfile(pending[m][0])]
+                for m in lost:
+                    del pending[m]
+                if lost:
+                    print(f"WARNING: staging request failed (exit {proc.returncode}) for {len(lost)} files, "
+                          f"see staging.log", file=sys.stderr)
+                failed.extend(lost)
+            requests = [r for r in requests if r[0].poll() is None]
+
+            # --- files in cache whose size has settled
+            now = time.time()
+            for mss, entry in list(pending.items()):
+                cache, since, last = entry
+                size = os.path.getsize(cache) if os.path.isfile(cache) else -1
+                if size > 0 and size == last:
+                    ready.append(mss)
+                    del pending[mss]
+                elif now - since > a.timeout:
+                    print(f"WARNING: {mss} not in cache after {a.timeout:.0f}s (giving up)", file=sys.stderr)
+                    failed.append(mss)
+                    del pending[mss]
+                else:
+                    entry[2] = size
+
+            # --- hand ready files to the converters; a partial group only once staging is idle
+            while ready and len(running) < a.workers and (len(ready) >= a.files_per_job or not (todo or pending)):
+                group, ready = ready[:a.files_per_job], ready[a.files_per_job:]
+                tag = os.path.splitext(os.path.basename(group[0]))[0]
+                files = [cache_path(m, a.mss_prefix, a.cache_prefix) for m in group]
+                fut = pool.submit(convert, files, a.out_dir, extra, tag)
+                fut.mss = group
+                running.add(fut)
+                jobs += 1
+
+            for fut in [f for f in running if f.done()]:
+                running.discard(fut)
+                _, ok, secs = fut.result()
+                if ok:
+                    done_file.writelines(m + "\n" for m in fut.mss)
+                    done_file.flush()
+                    done.update(fut.mss)
+                else:
+                    failed.extend(fut.mss)
+                print(f"[{time.time() - t0:7.0f}s] {'converted' if ok else 'FAILED'} {' '.join(fut.mss)} in {secs:.0f}s"
+                      f"  (pending {len(pending)}, ready {len(ready)}, converting {len(running)})", flush=True)
+
+            if running:
+                wait(running, timeout=a.poll, return_when=FIRST_COMPLETED)
+            elif todo or pending or ready:
+                time.sleep(a.poll)
+
+    for proc, _ in requests:
+        proc.wait()
+    log.close()
+    print(f"{len(done)} files converted in {jobs} converter runs, {len(failed)} failed, "
+          f"{time.time() - t0:.0f}s wall")
+    if failed:
+        with open(os.path.join(a.out_dir, "failed.txt"), "w") as f:
+            f.writelines(m + "\n" for m in failed)
+        print(f"failed files listed in {a.out_dir}/failed.txt (re-run to retry)")
+    sys.exit(1 if failed else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -17,5 +17,16 @@ cd /w/hallb-scshelf2102/clas12/bulgakov/projects/momcor/proton_corr/utils/hipo2r
 
 
 
-# Run the executable with the job array index (if needed)
-srun clas12root -q -b hipo2root.c  --in=AlexSimuNewRunsEdge.dat
\ No newline at end of file
+# Sharded mode: shard_convert.py submits this script as a job array with
+# SHARD_DIR set (one shard per array task) and, with MERGE_OUT set, once more
+# as the dependent merge job. Plain `sbatch RunsConvert.sh` converts the whole list.
+if [ -n "$MERGE_OUT" ]; then
+    srun python3 shard_convert.py merge "$SHARD_DIR" --out "$MERGE_OUT" --jobs "${MERGE_JOBS:-8}"
+elif [ -n "$SHARD_DIR" ]; then
+    srun python3 shard_convert.py task "$SHARD_DIR" "$SLURM_ARRAY_TASK_ID"
+else
+    # Run the executable with the job array index (if needed)
+    # (on tight nodes add e.g. --mem-budget=2000 --max-output=20000 to bound the
+    #  output buffers well inside --mem-per-cpu; per-file RSS is in the run report)
+    srun clas12root -q -b hipo2root.c  --in=AlexSimuNewRunsEdge.dat
+fi
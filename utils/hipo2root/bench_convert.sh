@@ -0,0 +1,207 @@
+#!/bin/bash
+# Converter benchmarks. Run from utils/hipo2root with the clas12root environment loaded.
+#
+#   ./bench_convert.sh threads <filelist.dat> [maxThreads]
+#       scaling report for --threads=1..maxThreads (default: nproc)
+#   ./bench_convert.sh rate <filelist.dat> <git-rev> [git-rev...]
+#       events/s of hipo2root.c as it was at each revision (before/after comparisons)
+#   ./bench_convert.sh presets <filelist.dat>
+#       file size, conversion time and RDataFrame read time for each output layout preset
+#   ./bench_convert.sh formats <filelist.dat>
+#       the same table for --format=ttree vs --format=rntuple at a few compression settings
+#   ./bench_convert.sh readahead <filelist.dat> [depth...]
+#       events/s without (depth 0) and with the --read-ahead reader thread, cold and warm page cache
+#   ./bench_convert.sh mmap <filelist.dat> [windowMB...]
+#       events/s of the plain reader (window 0) vs --mmap=<window>, cold and warm page cache
+#   ./bench_convert.sh binary <filelist.dat> [converter options...]
+#       startup time (empty list) and events/s of the clas12root macro vs the compiled
+#       ./hipo2root (hipo2root_main.cxx, build it first)
+#   ./bench_convert.sh precision <filelist.dat> [converter options...]
+#       file size, convert and read time for --precision=full vs reduced; with the analysis
+#       built (ANALYSIS_EXE, default ../../analysis/executable) also the largest change of the
+#       delta_P_VS_P_rec_FD_unified_1D fit parameters, absolute and in units of their error
+
+MODE="$1"
+LIST="$2"
+OUT_DIR="${BENCH_OUT:-/tmp/hipo2root_bench}"
+
+if [ -z "$MODE" ] || [ ! -f "$LIST" ]; then
+    echo "Usage: $0 threads|rate|presets|formats|readahead|mmap|precision|binary <filelist.dat> [args...]"
+    exit 1
+fi
+mkdir -p "$OUT_DIR"
+LIST="$(readlink -f "$LIST")"
+
+# converter command; "binary" mode switches it to the compiled ./hipo2root
+CONVERT=(clas12root -q -b hipo2root.c)
+
+# run_convert <tag> <extra args...>  -> prints "<seconds> <rows kept> <events streamed>"
+# Runs the converter from the current directory on $LIST.
+run_convert() {
+    local tag="$1"; shift
+    local out="$OUT_DIR/$tag.root"
+    local t0 t1
+    t0=$(date +%s.%N)
+    "${CONVERT[@]}" --in="$LIST" --out="$out" "$@" > "$OUT_DIR/$tag.log" 2>&1
+    t1=$(date +%s.%N)
+    local kept streamed
+    kept=$(grep "Events kept" "$OUT_DIR/$tag.log" | awk '{print $NF}')
+    streamed=$(grep "Total events (streamed)" "$OUT_DIR/$tag.log" | awk '{print $NF}')
+    echo "$(echo "$t1 - $t0" | bc -l) ${kept:-0} ${streamed:-0}"
+}
+
+# drop_cache -> evicts the input files from the page cache (root, or vmtouch -e); fails otherwise
+drop_cache() {
+    if [ -w /proc/sys/vm/drop_caches ]; then
+        sync && echo 3 > /proc/sys/vm/drop_caches
+    elif command -v vmtouch > /dev/null; then
+        xargs -a "$LIST" vmtouch -qe
+    else
+        return 1
+    fi
+}
+
+case "$MODE" in
+threads)
+    MAX="${3:-$(nproc)}"
+    printf "%-8s %10s %10s %10s %12s\n" "threads" "wall[s]" "speedup" "effic." "rows"
+    base=""
+    for n in $(seq 1 "$MAX"); do
+        read -r secs rows _ < <(run_convert "threads_$n" --threads="$n")
+        [ -z "$base" ] && base="$secs"
+        speedup=$(echo "$base / $secs" | bc -l)
+        effic=$(echo "$speedup / $n" | bc -l)
+        printf "%-8d %10.1f %10.2f %10.2f %12s\n" "$n" "$secs" "$speedup" "$effic" "$rows"
+    done
+    ;;
+rate)
+    shift 2
+    REPO_TOP="$(git rev-parse --show-toplevel)"
+    printf "%-14s %10s %12s %12s %12s\n" "revision" "wall[s]" "events" "rows" "ev/s"
+    for rev in "$@"; do
+        dir=$(mktemp -d)
+        git -C "$REPO_TOP" archive "$rev:utils/hipo2root" | tar -x -C "$dir"
+        read -r secs rows events < <(cd "$dir" && run_convert "rate_$rev")
+        printf "%-14s %10.1f %12s %12s %12.0f\n" "$rev" "$secs" "$events" "$rows" "$(echo "$events / $secs" | bc -l)"
+        rm -rf "$dir"
+    done
+    ;;
+presets|formats)
+    # name | converter options
+    [ "$MODE" = "presets" ] && PRESETS=(
+        "default|"
+        "zlib-1|--compress=zlib:1"
+        "lz4-4|--compress=lz4:4"
+        "zstd-5|--compress=zstd:5"
+        "lzma-8|--compress=lzma:8"
+        "zstd-5-small-clusters|--compress=zstd:5 --autoflush=-5000000"
+        "zstd-5-big-clusters|--compress=zstd:5 --basket=512000 --autoflush=-100000000"
+        "lz4-4-big-clusters|--compress=lz4:4 --basket=512000 --autoflush=-100000000"
+    )
+    [ "$MODE" = "formats" ] && PRESETS=(
+        "ttree-default|--format=ttree"
+        "rntuple-default|--format=rntuple"
+        "ttree-zstd-5|--format=ttree --compress=zstd:5"
+        "rntuple-zstd-5|--format=rntuple --compress=zstd:5"
+        "ttree-lz4-4|--format=ttree --compress=lz4:4"
+        "rntuple-lz4-4|--format=rntuple --compress=lz4:4"
+    )
+    printf "%-24s %10s %12s %12s\n" "preset" "size[MB]" "convert[s]" "read[s]"
+    for p in "${PRESETS[@]}"; do
+        name="${p%%|*}"
+        opts="${p#*|}"
+        # shellcheck disable=SC2086
+        read -r secs _ _ < <(run_convert "preset_$name" $opts)
+        out="$OUT_DIR/preset_$name.root"
+        size=$(echo "$(stat -c %s "$out" 2>/dev/null || echo 0) / 1048576" | bc -l)
+        rsecs=$(root -l -b -q "bench_read.C(\"$out\")" 2>/dev/null | grep "^Read:" | awk '{print $(NF-1)}')
+        printf "%-24s %10.1f %12.1f %12s\n" "$name" "$size" "$secs" "${rsecs:-n/a}"
+    done
+    ;;
+readahead|mmap)
+    shift 2
+    VALUES=("$@")
+    if [ "$MODE" = "readahead" ]; then
+        [ ${#VALUES[@]} -eq 0 ] && VALUES=(0 16 64 256)
+        OPT="--read-ahead"
+    else
+        [ ${#VALUES[@]} -eq 0 ] && VALUES=(0 16 64 256)
+        OPT="--mmap"
+    fi
+    drop_cache || echo "warning: cannot drop the page cache (needs root or vmtouch); 'cold' runs are warm" >&2
+    printf "%-8s %12s %12s %12s %12s\n" "$OPT" "cold[s]" "cold ev/s" "warm[s]" "warm ev/s"
+    for v in "${VALUES[@]}"; do
+        drop_cache
+        read -r csecs _ events < <(run_convert "${MODE}_${v}_cold" "$OPT=$v")
+        read -r wsecs _ _ < <(run_convert "${MODE}_${v}_warm" "$OPT=$v")
+        printf "%-8s %12.1f %12.0f %12.1f %12.0f\n" "$v" "$csecs" "$(echo "$events / $csecs" | bc -l)" \
+            "$wsecs" "$(echo "$events / $wsecs" | bc -l)"
+    done
+    ;;
+precision)
+    shift 2
+    EXE="$(readlink -f "${ANALYSIS_EXE:-../../analysis/executable}")"
+    printf "%-10s %10s %12s %12s\n" "precision" "size[MB]" "convert[s]" "read[s]"
+    for prec in full reduced; do
+        read -r secs _ _ < <(run_convert "precision_$prec" --precision="$prec" "$@")
+        out="$OUT_DIR/precision_$prec.root"
+        size=$(echo "$(stat -c %s "$out" 2>/dev/null || echo 0) / 1048576" | bc -l)
+        rsecs=$(root -l -b -q "bench_read.C(\"$out\")" 2>/dev/null | grep "^Read:" | awk '{print $(NF-1)}')
+        printf "%-10s %10.1f %12.1f %12s\n" "$prec" "$size" "$secs" "${rsecs:-n/a}"
+        if [ -x "$EXE" ]; then
+            mkdir -p "$OUT_DIR/analysis_$prec"
+            (cd "$(dirname "$EXE")" && ANALYSIS_PRINT_FITS=1 "$EXE" "$out" "$OUT_DIR/analysis_$prec/") 2>&1 \
+                | grep "^\[fit\]" > "$OUT_DIR/precision_$prec.fits"
+        fi
+    done
+    if [ -s "$OUT_DIR/precision_full.fits" ]; then
+        # per fit, the parameter (A..E) that moved most in units of its error
+        python3 - "$OUT_DIR/precision_full.fits" "$OUT_DIR/precision_reduced.fits" <<'PY'
+import sys
+def load(path):
+    fits = {}
+    for line in open(path):
+        tag, *kv = line.split()[1:]
+        fits[tag] = {k: float(v) for k, v in (x.split("=") for x in kv)}
+    return fits
+full, red = load(sys.argv[1]), load(sys.argv[2])
+for tag in sorted(full):
+    if tag not in red:
+        print(f"{tag}: missing in reduced run")
+        continue
+    pull = lambda p: abs(red[tag][p] - full[tag][p]) / full[tag]["e" + p] if full[tag]["e" + p] > 0 else float("inf")
+    worst = max("ABCDE", key=pull)
+    d = abs(red[tag][worst] - full[tag][worst])
+    print(f"{tag}: max |delta| = {d:.3e} on {worst} ({pull(worst):.3f} sigma)")
+PY
+    else
+        echo "(fit comparison skipped: build the analysis as $EXE)"
+    fi
+    ;;
+binary)
+    shift 2
+    if [ ! -x ./hipo2root ]; then
+        echo "build ./hipo2root first (see hipo2root_main.cxx)"
+        exit 1
+    fi
+    EMPTY="$OUT_DIR/empty.dat"
+    : > "$EMPTY"
+    printf "%-8s %12s %10s %12s %12s\n" "runner" "startup[s]" "wall[s]" "events" "ev/s"
+    for runner in macro binary; do
+        if [ "$runner" = "macro" ]; then CONVERT=(clas12root -q -b hipo2root.c); else CONVERT=(./hipo2root); fi
+        # startup: the whole run on an empty list, best of 3
+        startup=""
+        for _ in 1 2 3; do
+            read -r s _ _ < <(LIST="$EMPTY" run_convert "binary_${runner}_empty")
+            if [ -z "$startup" ] || [ "$(echo "$s < $startup" | bc -l)" = 1 ]; then startup="$s"; fi
+        done
+        read -r secs _ events < <(run_convert "binary_$runner" "$@")
+        printf "%-8s %12.2f %10.1f %12s %12.0f\n" "$runner" "$startup" "$secs" "$events" \
+            "$(echo "$events / $secs" | bc -l)"
+    done
+    ;;
+*)
+    echo "Unknown mode: $MODE"
+    exit 1
+    ;;
+esac
@@ -0,0 +1,228 @@
+#pragma once
+// The event loop shared by the MC and data converters.
+//
+// ConvertFile<Schema> reads one HIPO file and hands every event to the output
+// schema (schemas.h): Schema::select() runs on the particle banks only, and
+// Schema::fill() sets the output row once REC::Track/REC::Traj are decoded.
+// Schemas are templated on the mode. McMode reads MC::Particle; DataMode has
+// no MC bank at all, and the `if constexpr` branches on Mode::kMC drop the
+// other mode's code at compile time.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "hipo_banks.h"
+#include "event_index.h"
+#include "skim_index.h"
+#include "row_io.h"
+#include "run_report.h"
+#include "event_ring.h"
+#include "input_hints.h"
+
+namespace h2r {
+
+struct McMode {
+  static constexpr bool kMC = true;
+};
+
+struct DataMode {
+  static constexpr bool kMC = false;
+};
+
+// Stand-in for the MC bank in data mode; never read.
+struct NoBank {};
+
+// Bank views of one input file, with MC::Particle only in MC mode.
+template <class Mode>
+struct EventBanks {
+  using McBank = std::conditional_t<Mode::kMC, McParticleBank, NoBank>;
+
+  explicit EventBanks(hipo::dictionary& dict)
+      : REC_particle(dict.getSchema("REC::Particle")), MC_particle(makeMcBank(dict)),
+        REC_track(dict.getSchema("REC::Track")), REC_traj(dict.getSchema("REC::Traj")) {}
+
+  RecParticleBank REC_particle;
+  McBank          MC_particle;
+  RecTrackBank    REC_track;
+  RecTrajBank     REC_traj;
+
+ private:
+  static McBank makeMcBank(hipo::dictionary& dict) {
+    if constexpr (Mode::kMC) return McBank(dict.getSchema("MC::Particle"));
+    else                     return McBank{};
+  }
+};
+
+inline std::mutex gLogMutex;   // keeps per-file lines whole when workers print
+
+// What a conversion run shares between its files and workers; all optional.
+struct RunContext {
+  const SkimIndex* skimIn  = nullptr;   // seek to recorded candidates only
+  SkimIndex*       skimOut = nullptr;   // record this run's candidates
+  RunReport*       report  = nullptr;   // per-file stats, progress line
+  size_t           readAhead = 0;       // events a reader thread may read ahead per file, 0 = read inline
+  size_t           prefetchBytes = 0;   // mmap/madvise read-ahead window per file, 0 = no hints
+};
+
+// --- Convert one HIPO file: every kept event is set in `r` and written by `out`.
+template <class Schema>
+FileStats ConvertFile(const std::string& filePath, RowWriter& out, typename Schema::Row& r, const RunContext& ctx) {
+  using Mode = typename Schema::Mode;
+  FileStats  st;
+  StageClock clock(st);
+  st.inputBytes = fileSize(filePath);
+
+  auto finish = [&]() -> FileStats {
+    st.peakRss = peakRssKB();
+    st.rss     = rssKB();
+    if (ctx.report) ctx.report->addFile(filePath, st);
+    return st;
+  };
+
+  // --- with a valid skim entry only its candidate events are read
+  const SkimIndex::FileEntry* skim = ctx.skimIn ? ctx.skimIn->lookup(filePath) : nullptr;
+  if (skim && skim->candidates.empty()) {
+    if (ctx.skimOut) ctx.skimOut->record(filePath, skim->events, {});
+    st.inputBytes = 0;
+    {
+      std::lock_guard<std::mutex> lock(gLogMutex);
+      std::cout << filePath << " : no candidates in skim index (skipped)\n";
+    }
+    return finish();
+  }
+
+  hipo::reader reader;
+  reader.open(filePath.c_str());
+  if (!reader.is_open()) {
+    {
+      std::lock_guard<std::mutex> lock(gLogMutex);
+      std::cerr << "WARNING: cannot open " << filePath << " (skipping)\n";
+    }
+    return finish();
+  }
+  hipo::dictionary dict; reader.readDictionary(dict);
+  if (!dict.hasSchema("REC::Particle") || (Mode::kMC && !dict.hasSchema("MC::Particle"))) {
+    {
+      std::lock_guard<std::mutex> lock(gLogMutex);
+      std::cerr << "WARNING: required banks missing in " << filePath << " (skipping)\n";
+    }
+    return finish();
+  }
+
+  EventBanks<Mode>  b(dict);
+  ParticleIndex     assoc;
+  typename Schema::Pick pick;
+
+  // optional page-cache read-ahead; the reader position is estimated from the event number
+  InputHints hints(filePath, ctx.prefetchBytes);
+  const double nEntries = hints.kind() != InputHints::kOff ? std::max(1, reader.getEntries()) : 1.;
+  if (ctx.prefetchBytes > 0 && hints.kind() != InputHints::kMmap) {
+    std::lock_guard<std::mutex> lock(gLogMutex);
+    std::cerr << "WARNING: cannot mmap " << filePath
+              << (hints.kind() == InputHints::kFadvise ? " (using posix_fadvise)\n" : " (no read-ahead hints)\n");
+  }
+  clock.lap(kOpen);
+
+  std::vector<int> candidates;        // event ordinals passing the preselection
+  int    evNo    = -1;
+  size_t nextSkim = 0;
+  auto advance = [&]() -> bool {
+    if (!skim) { ++evNo; return reader.next(); }
+    if (nextSkim >= skim->candidates.size()) return false;
+    evNo = skim->candidates[nextSkim++];
+    return reader.gotoEvent(evNo);
+  };
+
+  constexpr long long kProgressEvery = 4096;   // events between progress updates
+
+  // Everything after the record read; `event` holds event number `evn`.
+  auto process = [&](hipo::event& event, int evn) {
+    ++st.events;
+    if (ctx.report && st.events % kProgressEvery == 0) ctx.report->progress(kProgressEvery);
+    if (st.events % 256 == 0) hints.advance(evn / nEntries);
+    clock.lap(kRead);
+
+    // stage 1: particle banks only; track/traj wait for the PID preselection
+    event.getStructure(b.REC_particle.bank);
+    if constexpr (Mode::kMC) event.getStructure(b.MC_particle.bank);
+    clock.lap(kDecode);
+
+    const bool selected = Schema::select(b, pick);
+    clock.lap(kSelect);
+    if (!selected) {
+      // count the track+traj bytes of an event that never gets to stage 2
+      ++st.lateSkipped;
+      st.bytesSkipped += bankBytes(event, b.REC_track.bank) + bankBytes(event, b.REC_traj.bank);
+      return;
+    }
+
+    candidates.push_back(evn);
+
+    // stage 2: e+p candidate, decode the association banks
+    event.getStructure(b.REC_track.bank);
+    event.getStructure(b.REC_traj.bank);
+    st.lateSeconds += clock.lap(kDecode);
+    st.bytesDecoded += b.REC_track.bank.getSize() + b.REC_traj.bank.getSize();
+    ++st.lateDecoded;
+
+    assoc.build(b.REC_track, b.REC_traj, b.REC_particle.rows());
+    const bool filled = Schema::fill(b, assoc, pick, r);
+    clock.lap(kFill);
+    if (!filled) return;
+
+    out.Fill();
+    ++st.kept;
+    clock.lap(kWrite);
+  };
+
+  if (ctx.readAhead > 0) {
+    // reader thread fills the ring; "read" time is then the wait for a ready event
+    EventRing ring(ctx.readAhead);
+    std::thread producer([&] {
+      while (EventRing::Slot* slot = ring.acquire()) {
+        if (!advance()) break;
+        reader.read(slot->event);
+        slot->evNo = evNo;
+        ring.publish();
+      }
+      ring.close();
+    });
+    try {
+      while (EventRing::Slot* slot = ring.next()) {
+        process(slot->event, slot->evNo);
+        ring.release();
+      }
+    } catch (...) {
+      // a joinable std::thread must not be destroyed: release the producer first
+      ring.stop();
+      producer.join();
+      throw;
+    }
+    producer.join();
+  } else {
+    hipo::event event;
+    while (advance()) {
+      reader.read(event);               // <-- read every event (don’t skip the first)
+      process(event, evNo);
+    }
+  }
+  if (ctx.report) ctx.report->progress(st.events % kProgressEvery);
+
+  if (ctx.skimOut) ctx.skimOut->record(filePath, skim ? skim->events : st.events, std::move(candidates));
+
+  {
+    std::lock_guard<std::mutex> lock(gLogMutex);
+    std::cout << filePath << " : " << st.events << " events" << (skim ? " (skim)" : "")
+              << ", rss " << rssKB() / 1024 << " MB\n";
+  }
+  return finish();
+}
+
+} // namespace h2r
@@ -0,0 +1,69 @@
+#pragma once
+// Per-event association of REC::Particle rows with their REC::Track and DC
+// REC::Traj rows.
+//
+// build() walks REC::Track and REC::Traj once each; the fill code then asks for
+// a particle's sector or DC crossing by pindex in O(1) instead of rescanning the
+// banks for every particle it writes out.
+
+#include <vector>
+
+#include "hipo_banks.h"
+
+namespace h2r {
+
+enum DCLayer { kDC_R1 = 0, kDC_R2 = 1, kDC_R3 = 2 };   // traj layers 6, 18, 36
+
+class ParticleIndex {
+ public:
+  static constexpr int kDetectorDC = 6;
+
+  // Rows reference the banks passed here; rebuild after every getStructure().
+  void build(const RecTrackBank& track, const RecTrajBank& traj, int nParticles) {
+    track_ = &track;
+    entries_.assign(nParticles > 0 ? nParticles : 0, Entry{});
+
+    // first REC::Track row of a particle wins
+    for (int i = 0, Nt = track.rows(); i < Nt; ++i) {
+      const int p = track.pindex(i);
+      if (p >= 0 && p < nParticles && entries_[p].trackRow < 0) entries_[p].trackRow = i;
+    }
+
+    // last DC crossing of a layer wins
+    for (int i = 0, Ntj = traj.rows(); i < Ntj; ++i) {
+      if (traj.detector(i) != kDetectorDC) continue;
+      const int p = traj.pindex(i);
+      if (p < 0 || p >= nParticles) continue;
+      switch (traj.layer(i)) {
+        case 6:  entries_[p].dcRow[kDC_R1] = i; break;
+        case 18: entries_[p].dcRow[kDC_R2] = i; break;
+        case 36: entries_[p].dcRow[kDC_R3] = i; break;
+        default: break;
+      }
+    }
+  }
+
+  bool has(int pindex) const { return pindex >= 0 && pindex < static_cast<int>(entries_.size()); }
+
+  // REC::Track sector of the particle, -1 if it has no track
+  int sector(int pindex) const {
+    if (!has(pindex) || entries_[pindex].trackRow < 0) return -1;
+    return track_->sector(entries_[pindex].trackRow);
+  }
+
+  // REC::Traj row of the particle's DC crossing at `layer`, -1 if none
+  int dcRow(int pindex, DCLayer layer) const {
+    return has(pindex) ? entries_[pindex].dcRow[layer] : -1;
+  }
+
+ private:
+  struct Entry {
+    int trackRow = -1;
+    int dcRow[3] = {-1, -1, -1};
+  };
+
+  const RecTrackBank* track_ = nullptr;
+  std::vector<Entry>  entries_;   // indexed by pindex; capacity is reused across events
+};
+
+} // namespace h2r
@@ -0,0 +1,75 @@
+#pragma once
+// Bounded ring of HIPO event buffers between a reader thread and the event loop.
+//
+// The producer (reader thread) reads the next events into free slots while the
+// consumer (the converter's event loop) decodes and fills the ones already
+// read, so record I/O and decompression overlap with selection and Fill().
+// Single producer, single consumer; a full ring blocks the producer
+// (back-pressure), an empty one blocks the consumer. Slots are reused, so the
+// event buffers are allocated once per file.
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "clas12reader.h"
+
+namespace h2r {
+
+class EventRing {
+ public:
+  struct Slot {
+    hipo::event event;
+    int         evNo = -1;   // event ordinal in the file
+  };
+
+  explicit EventRing(size_t depth) : slots_(depth > 0 ? depth : 1) {}
+
+  // --- producer
+  // Next free slot to read into; blocks while the ring is full, nullptr once
+  // the consumer has stopped.
+  Slot* acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notFull_.wait(lock, [&] { return written_ - read_ < slots_.size() || stopped_; });
+    return stopped_ ? nullptr : &slots_[written_ % slots_.size()];
+  }
+  // Hands the slot returned by acquire() to the consumer.
+  void publish() {
+    { std::lock_guard<std::mutex> lock(mutex_); ++written_; }
+    notEmpty_.notify_one();
+  }
+  // No more events.
+  void close() {
+    { std::lock_guard<std::mutex> lock(mutex_); closed_ = true; }
+    notEmpty_.notify_one();
+  }
+
+  // --- consumer
+  // Oldest published slot; blocks while the ring is empty, nullptr at the end.
+  Slot* next() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    notEmpty_.wait(lock, [&] { return read_ < written_ || closed_; });
+    return read_ < written_ ? &slots_[read_ % slots_.size()] : nullptr;
+  }
+  // Returns the slot from next() to the producer.
+  void release() {
+    { std::lock_guard<std::mutex> lock(mutex_); ++read_; }
+    notFull_.notify_one();
+  }
+  // Stops the producer early: its acquire() returns nullptr from then on. Used
+  // when the consumer gives up on the file (process() or Fill() threw).
+  void stop() {
+    { std::lock_guard<std::mutex> lock(mutex_); stopped_ = true; }
+    notFull_.notify_one();
+  }
+
+ private:
+  std::vector<Slot>       slots_;
+  std::mutex              mutex_;
+  std::condition_variable notFull_, notEmpty_;
+  size_t                  written_ = 0, read_ = 0;   // running counts; slot = count % depth
+  bool                    closed_ = false, stopped_ = false;
+};
+
+} // namespace h2r
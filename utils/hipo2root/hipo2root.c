@@ -6,6 +6,10 @@
 #include <cmath>
 #include <iomanip>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <utility>
 #include <TSystem.h>
 
 #include <TFile.h>
@@ -15,42 +19,255 @@
 #include <TLorentzVector.h>
 #include <TVector3.h>
 #include <TBenchmark.h>
+#include <Compression.h>
+#include <ROOT/TBufferMerger.hxx>
 #include "clas12reader.h"
+#include "schemas.h"
+#include "shard_manifest.h"
+#include "input_catalog.h"
+#include "precision.h"
 
 using namespace clas12;
+using h2r::FileStats;
+using h2r::RunContext;
+using h2r::gLogMutex;
 
 struct Args {
   TString inList;
   TString outRoot;   // optional
+  int     nThreads = 1;
+  TString skimIn;    // optional: only convert the events listed in this index
+  TString skimOut;   // optional: write the e+p candidate index here
+  TString shardDir;  // optional: one ROOT shard per filesPerShard inputs + manifest
+  int     filesPerShard = 1;
+  int      compress  = -1;   // ROOT compression setting (alg*100 + level), -1 = ROOT default
+  int      basket    = 0;    // basket size in bytes for every branch, 0 = ROOT default
+  Long64_t autoFlush = 0;    // TTree::SetAutoFlush value (>0 entries, <0 bytes), 0 = ROOT default
+  h2r::Format format = h2r::Format::kTTree;
+  bool     data      = false;  // data mode: no MC::Particle, data selection and branch set
+  h2r::SchemaKind schema = h2r::SchemaKind::kScalar;
+  TString  report;           // JSON run report; default <out>.report.json or <shard-dir>/report.json
+  double   progress  = 0;    // seconds between progress lines, 0 = off
+  int      readAhead = 0;    // events buffered by a per-file reader thread, 0 = no reader thread
+  int      prefetchMB = 0;   // mmap + madvise read-ahead window per input file [MB], 0 = off
+  TString  catalog;          // optional: hipo_catalog.c output, known-bad inputs are skipped
+  TString  precisionSpec = "full";          // --precision= as given, for the run report
+  std::vector<h2r::PrecisionRule> precision;   // empty = full float precision
+  int      memBudgetMB = 0;  // output buffer memory for all writers together [MB], 0 = ROOT defaults
+  int      maxOutputMB = 0;  // roll over to <out>_N.root once the output reaches this size [MB], 0 = never
 };
 
-static Args parse_args() {
+// "<alg>[:<level>]" with alg one of zlib, lzma, lz4, zstd -> ROOT compression setting, -1 if invalid
+static int parse_compression(TString spec) {
+  spec.ToLower();
+  int level = 5;
+  const Ssiz_t colon = spec.First(':');
+  if (colon != kNPOS) {
+    level = TString(spec(colon + 1, spec.Length() - colon - 1)).Atoi();
+    spec  = spec(0, colon);
+  }
+  if (level < 0 || level > 9) return -1;
+  if (spec == "zlib") return ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kZLIB, level);
+  if (spec == "lzma") return ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kLZMA, level);
+  if (spec == "lz4")  return ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kLZ4,  level);
+  if (spec == "zstd") return ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kZSTD, level);
+  return -1;
+}
+
+// argv[1..argc) as given to the macro (gApplication) or to hipo2root_main.cxx
+static Args parse_args(int argc, char** argv, bool data = false) {
   Args a;
-  for (Int_t i = 1; i < gApplication->Argc(); ++i) {
-    TString opt = gApplication->Argv(i);
+  a.data = data;
+  for (Int_t i = 1; i < argc; ++i) {
+    TString opt = argv[i];
     if (opt.BeginsWith("--in=")) {
       a.inList = opt(5, opt.Length() - 5);     // everything after "--in="
     } else if (opt.BeginsWith("--out=")) {
       a.outRoot = opt(6, opt.Length() - 6);    // everything after "--out="
+    } else if (opt.BeginsWith("--threads=")) {
+      a.nThreads = TString(opt(10, opt.Length() - 10)).Atoi();
+    } else if (opt.BeginsWith("--skim-in=")) {
+      a.skimIn = opt(10, opt.Length() - 10);
+    } else if (opt.BeginsWith("--skim-out=")) {
+      a.skimOut = opt(11, opt.Length() - 11);
+    } else if (opt.BeginsWith("--shard-dir=")) {
+      a.shardDir = opt(12, opt.Length() - 12);
+    } else if (opt.BeginsWith("--files-per-shard=")) {
+      a.filesPerShard = TString(opt(18, opt.Length() - 18)).Atoi();
+    } else if (opt.BeginsWith("--compress=")) {
+      a.compress = parse_compression(opt(11, opt.Length() - 11));
+      if (a.compress < 0) {
+        std::cerr << "ERROR: bad " << opt << " (expected zlib|lzma|lz4|zstd[:0-9])\n";
+        gSystem->Exit(1);
+      }
+    } else if (opt.BeginsWith("--basket=")) {
+      a.basket = TString(opt(9, opt.Length() - 9)).Atoi();
+    } else if (opt.BeginsWith("--autoflush=")) {
+      a.autoFlush = TString(opt(12, opt.Length() - 12)).Atoll();
+    } else if (opt.BeginsWith("--format=")) {
+      if (!h2r::parseFormat(TString(opt(9, opt.Length() - 9)).Data(), a.format)) {
+        std::cerr << "ERROR: bad " << opt << " (expected ttree|rntuple)\n";
+        gSystem->Exit(1);
+      }
+    } else if (opt.BeginsWith("--schema=")) {
+      if (!h2r::parseSchema(TString(opt(9, opt.Length() - 9)).Data(), a.schema)) {
+        std::cerr << "ERROR: bad " << opt << " (expected scalar|multi)\n";
+        gSystem->Exit(1);
+      }
+    } else if (opt.BeginsWith("--report=")) {
+      a.report = opt(9, opt.Length() - 9);
+    } else if (opt.BeginsWith("--progress=")) {
+      a.progress = TString(opt(11, opt.Length() - 11)).Atof();
+    } else if (opt.BeginsWith("--read-ahead=")) {
+      a.readAhead = TString(opt(13, opt.Length() - 13)).Atoi();
+    } else if (opt == "--mmap") {
+      a.prefetchMB = 64;
+    } else if (opt.BeginsWith("--mmap=")) {
+      a.prefetchMB = TString(opt(7, opt.Length() - 7)).Atoi();
+    } else if (opt.BeginsWith("--precision=")) {
+      a.precisionSpec = opt(12, opt.Length() - 12);
+      if (!h2r::parsePrecision(a.precisionSpec.Data(), a.precision)) {
+        std::cerr << "ERROR: bad " << opt << " (expected full|reduced|PATTERN:BITS[,...])\n";
+        gSystem->Exit(1);
+      }
+    } else if (opt.BeginsWith("--mem-budget=")) {
+      a.memBudgetMB = TString(opt(13, opt.Length() - 13)).Atoi();
+    } else if (opt.BeginsWith("--max-output=")) {
+      a.maxOutputMB = TString(opt(13, opt.Length() - 13)).Atoi();
+    } else if (opt.BeginsWith("--catalog=")) {
+      a.catalog = opt(10, opt.Length() - 10);
+    } else if (opt == "--data") {
+      a.data = true;
     } else if (opt.EndsWith(".dat") || opt.EndsWith(".txt")) {
       // allow bare list file as a convenience
       a.inList = opt;
     }
   }
   if (a.inList.IsNull()) {
-    std::cerr << "Usage: clas12root -q -b hipo2root.c --in=<filelist.dat> [--out=output.root]\n";
+    std::cerr << "Usage: clas12root -q -b hipo2root.c --in=<filelist.dat> [--out=output.root] [--threads=N]"
+                 " [--skim-in=index.skim] [--skim-out=index.skim]"
+                 " [--shard-dir=DIR [--files-per-shard=N]]"
+                 " [--compress=zstd:5] [--basket=BYTES] [--autoflush=N|-BYTES] [--format=ttree|rntuple] [--data] [--schema=scalar|multi]"
+                 " [--report=run.json] [--progress=SECONDS] [--read-ahead=EVENTS] [--mmap[=WINDOW_MB]]"
+                 " [--catalog=list.catalog.tsv] [--precision=full|reduced|PATTERN:BITS,...]"
+                 " [--mem-budget=MB] [--max-output=MB]\n";
+    gSystem->Exit(1);
+  }
+  if (a.nThreads < 1) a.nThreads = 1;
+  if (a.readAhead < 0) a.readAhead = 0;
+  if (a.filesPerShard < 1) a.filesPerShard = 1;
+  if (a.format == h2r::Format::kRNTuple && a.nThreads > 1 && a.shardDir.IsNull()) {
+    // the TBufferMerger path is TTree-only; shards give one RNTuple per worker instead
+    std::cerr << "ERROR: --format=rntuple with --threads needs --shard-dir\n";
     gSystem->Exit(1);
   }
-  if (a.outRoot.IsNull()) {
+  if (a.maxOutputMB > 0 && (a.nThreads > 1 || !a.shardDir.IsNull())) {
+    // the merger writes one file; shards are already bounded by --files-per-shard
+    std::cerr << "ERROR: --max-output is for serial runs (no --threads, no --shard-dir)\n";
+    gSystem->Exit(1);
+  }
+  if (a.outRoot.IsNull() && a.data) {
+    // data default kept from hipo2rootExp.c: the list name with .root appended
+    a.outRoot = Form("../../data/%s.root", a.inList.Data());
+  } else if (a.outRoot.IsNull()) {
     // default: <listBasename>_no_edge.root in CWD
     TString base = gSystem->BaseName(a.inList);
     base.ReplaceAll(".dat", "");
     base.ReplaceAll(".txt", "");
     a.outRoot = Form("../../data/%s.root", base.Data());
   }
+  if (a.report.IsNull()) {
+    a.report = a.shardDir.IsNull() ? a.outRoot + ".report.json" : a.shardDir + "/report.json";
+  }
   return a;
 }
 
+static Args parse_args(bool data = false) {
+  return parse_args(gApplication->Argc(), gApplication->Argv(), data);
+}
+
+static int CompressionFor(const Args& args) {
+  return args.compress >= 0 ? args.compress : ROOT::RCompressionSetting::EDefaults::kUseCompiledDefault;
+}
+
+// --- Output buffer memory of one writer under --mem-budget, split evenly over the
+//     --threads writers; 0 without a budget.
+static Long64_t WriterBudget(const Args& args) {
+  return args.memBudgetMB > 0 ? (Long64_t(args.memBudgetMB) << 20) / std::max(1, args.nThreads) : 0;
+}
+
+// --- Basket size and cluster (AutoFlush) layout; clusters are the unit RDataFrame
+//     splits work on under ImplicitMT, so they matter for read throughput.
+//     Under a memory budget the basket size is capped at budget/(4*branches): a
+//     tree holds about two buffers of basket size per branch while filling (the
+//     basket and its compressed copy), so the baskets take half of the writer's
+//     share and the rest is headroom for vector-column baskets growing past
+//     their size. Clusters are flushed every budget/8 compressed bytes, which
+//     also bounds the basket sizes TTree::OptimizeBaskets picks at the first flush.
+static void ApplyLayout(TTree& out_tree, const Args& args) {
+  if (args.basket > 0)     out_tree.SetBasketSize("*", args.basket);
+  if (args.autoFlush != 0) out_tree.SetAutoFlush(args.autoFlush);
+
+  if (const Long64_t budget = WriterBudget(args)) {
+    const int nBranches = std::max(1, out_tree.GetListOfBranches()->GetEntries());
+    const Long64_t cap  = budget / (4 * nBranches);
+    if (args.basket <= 0 || args.basket > cap) out_tree.SetBasketSize("*", int(std::max<Long64_t>(cap, 4096)));
+    if (args.autoFlush == 0) out_tree.SetAutoFlush(-budget / 8);
+    out_tree.SetMaxVirtualSize(budget);
+  }
+}
+
+// --- <out>.root for part 0, <out>_N.root after N roll-overs (the TTree::ChangeFile naming).
+static std::string OutputPart(const TString& out, int part) {
+  if (part == 0) return out.Data();
+  TString stem = out;
+  if (stem.EndsWith(".root")) stem.Remove(stem.Length() - 5);
+  return Form("%s_%d.root", stem.Data(), part);
+}
+
+// --- Create `path` in the requested output format and run body(writer), with the
+//     writer bound to `row`. Returns false if the output could not be created;
+//     `closeSeconds` gets the time spent writing out what was left after body().
+template <class Schema, class Body>
+static bool WriteOutput(const std::string& path, const Args& args, typename Schema::Row& row,
+                        double& closeSeconds, Body&& body) {
+  using clock = std::chrono::steady_clock;
+  const std::vector<h2r::Column> cols = h2r::WithPrecision(Schema::columns(), args.precision);
+  if (args.format == h2r::Format::kRNTuple) {
+    std::unique_ptr<h2r::RNTupleRowWriter> writer;
+    try {
+      // under a budget: the same cluster flush as for TTree, and a cap on the unzipped cluster
+      const Long64_t budget = WriterBudget(args);
+      writer = std::make_unique<h2r::RNTupleRowWriter>(path, "out_tree", cols, &row, args.compress,
+                                                       args.autoFlush < 0 ? -args.autoFlush : budget / 8,
+                                                       budget / 2);
+    } catch (const std::exception& e) {
+      std::cerr << "ERROR: cannot create RNTuple output " << path << ": " << e.what() << "\n";
+      return false;
+    }
+    h2r::RoundingRowWriter rounded(*writer, &row, cols);
+    body(rounded);
+    const auto t0 = clock::now();
+    writer.reset();   // commits the ntuple
+    closeSeconds = std::chrono::duration<double>(clock::now() - t0).count();
+    return true;
+  }
+
+  TFile outFile(path.c_str(), "RECREATE", "", CompressionFor(args));
+  if (outFile.IsZombie()) return false;
+  TTree out_tree("out_tree", "out_tree");
+  h2r::BookBranches(out_tree, &row, cols);
+  ApplyLayout(out_tree, args);
+  h2r::TTreeRowWriter writer(out_tree);
+  h2r::RoundingRowWriter rounded(writer, &row, cols);
+  body(rounded);
+  const auto t0 = clock::now();
+  outFile.Write();
+  outFile.Close();
+  closeSeconds = std::chrono::duration<double>(clock::now() - t0).count();
+  return true;
+}
+
 void ProcessHipo(const Args& args);
 
 void hipo2root() {
@@ -58,73 +275,174 @@ void hipo2root() {
   ProcessHipo(args);
 }
 
-void ProcessHipo(const Args& args) {
-  // --- Output file / tree
-  TFile outFile(args.outRoot, "RECREATE");
-  if (outFile.IsZombie()) {
-    std::cerr << "ERROR: cannot create output ROOT file: " << args.outRoot << "\n";
-    gSystem->Exit(2);
+// --- Serial path: one reader, one output, files in list order. With --max-output
+//     the output is closed after the input that takes it past the limit and the
+//     next inputs go to <out>_1.root, <out>_2.root, ...; an input is never split.
+template <class Schema>
+static FileStats ConvertSerial(const Args& args, const std::vector<std::string>& data, const RunContext& ctx) {
+  typename Schema::Row row;
+  FileStats total;
+  const long long maxBytes = static_cast<long long>(args.maxOutputMB) << 20;
+  size_t next = 0;
+  for (int part = 0; part == 0 || next < data.size(); ++part) {
+    const std::string path = OutputPart(args.outRoot, part);
+    double closeSeconds = 0.;
+    const bool ok = WriteOutput<Schema>(path, args, row, closeSeconds, [&](h2r::RowWriter& out) {
+      while (next < data.size()) {
+        total.add(h2r::ConvertFile<Schema>(data[next++], out, row, ctx));
+        if (maxBytes > 0 && out.bytesWritten() >= maxBytes) break;
+      }
+    });
+    if (!ok) {
+      std::cerr << "ERROR: cannot create output ROOT file: " << path << "\n";
+      gSystem->Exit(2);
+    }
+    total.seconds[h2r::kWrite] += closeSeconds;
+    if (ctx.report) ctx.report->addOutput(path);
+    if (next < data.size()) std::cout << "Output " << path << " reached --max-output, continuing in "
+                                      << OutputPart(args.outRoot, part + 1) << "\n";
   }
-  TTree out_tree("out_tree", "out_tree");
+  return total;
+}
 
-  // --- Branch variables
-  float px_prot_gen, py_prot_gen, pz_prot_gen, p_proton_gen;
-  float px_prot_rec, py_prot_rec, pz_prot_rec, p_proton_rec;
-  float vx_prot, vy_prot, vz_prot;
-  int   pid_proton, status_proton, sector_proton;
-
-  float px_electron_gen, py_electron_gen, pz_electron_gen, p_electron_gen;
-  float px_electron_rec, py_electron_rec, pz_electron_rec, p_electron_rec;
-  int   pid_electron, status_electron;
-
-  float edge1_electron, edge2_electron, edge3_electron;
-  float edge1_proton,   edge2_proton,   edge3_proton;
-
-  float x1_proton,   y1_proton,   z1_proton;
-  float x1_electron, y1_electron, z1_electron;
-
-  // --- Branches
-  out_tree.Branch("px_prot_gen", &px_prot_gen);
-  out_tree.Branch("py_prot_gen", &py_prot_gen);
-  out_tree.Branch("pz_prot_gen", &pz_prot_gen);
-  out_tree.Branch("px_prot_rec", &px_prot_rec);
-  out_tree.Branch("py_prot_rec", &py_prot_rec);
-  out_tree.Branch("pz_prot_rec", &pz_prot_rec);
-  out_tree.Branch("p_proton_gen", &p_proton_gen);
-  out_tree.Branch("p_proton_rec", &p_proton_rec);
-  out_tree.Branch("vx_prot", &vx_prot);
-  out_tree.Branch("vy_prot", &vy_prot);
-  out_tree.Branch("vz_prot", &vz_prot);
-  out_tree.Branch("pid_proton", &pid_proton);
-  out_tree.Branch("status_proton", &status_proton);
-  out_tree.Branch("sector_proton", &sector_proton);
-
-  out_tree.Branch("px_electron_gen", &px_electron_gen);
-  out_tree.Branch("py_electron_gen", &py_electron_gen);
-  out_tree.Branch("pz_electron_gen", &pz_electron_gen);
-  out_tree.Branch("p_electron_gen", &p_electron_gen);
-  out_tree.Branch("px_electron_rec", &px_electron_rec);
-  out_tree.Branch("py_electron_rec", &py_electron_rec);
-  out_tree.Branch("pz_electron_rec", &pz_electron_rec);
-  out_tree.Branch("p_electron_rec", &p_electron_rec);
-  out_tree.Branch("pid_electron", &pid_electron);
-  out_tree.Branch("status_electron", &status_electron);
-
-  out_tree.Branch("edge1_electron", &edge1_electron);
-  out_tree.Branch("edge2_electron", &edge2_electron);
-  out_tree.Branch("edge3_electron", &edge3_electron);
-  out_tree.Branch("edge1_proton", &edge1_proton);
-  out_tree.Branch("edge2_proton", &edge2_proton);
-  out_tree.Branch("edge3_proton", &edge3_proton);
-
-  out_tree.Branch("x1_proton", &x1_proton);
-  out_tree.Branch("y1_proton", &y1_proton);
-  out_tree.Branch("z1_proton", &z1_proton);
-
-  out_tree.Branch("x1_electron", &x1_electron);
-  out_tree.Branch("y1_electron", &y1_electron);
-  out_tree.Branch("z1_electron", &z1_electron);
+// --- Parallel path: each worker owns a reader, bank set and tree, pulls the next
+//     file index from a shared counter and hands its baskets to TBufferMerger
+//     after every file. Rows are identical to the serial path; only their order
+//     across input files depends on scheduling.
+template <class Schema>
+static FileStats ConvertParallel(const Args& args, const std::vector<std::string>& data, const RunContext& ctx) {
+  ROOT::EnableThreadSafety();
+  auto merger = std::make_unique<ROOT::TBufferMerger>(args.outRoot, "RECREATE", CompressionFor(args));
+
+  std::atomic<size_t> nextFile{0};
+  std::mutex          totalMutex;
+  FileStats           total;
+
+  auto worker = [&]() {
+    auto outFile = merger->GetFile();
+    TTree out_tree("out_tree", "out_tree");
+    typename Schema::Row row;
+    const std::vector<h2r::Column> cols = h2r::WithPrecision(Schema::columns(), args.precision);
+    h2r::BookBranches(out_tree, &row, cols);
+    ApplyLayout(out_tree, args);
+    h2r::TTreeRowWriter writer(out_tree);
+    h2r::RoundingRowWriter rounded(writer, &row, cols);
+
+    for (size_t i; (i = nextFile++) < data.size();) {
+      FileStats st = h2r::ConvertFile<Schema>(data[i], rounded, row, ctx);
+      const auto t0 = std::chrono::steady_clock::now();
+      outFile->Write();   // ship this file's rows to the merger, keeps worker memory flat
+      st.seconds[h2r::kWrite] += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+      std::lock_guard<std::mutex> lock(totalMutex);
+      total.add(st);
+    }
+  };
+
+  const int nWorkers = std::min<int>(args.nThreads, data.size());
+  std::vector<std::thread> pool;
+  for (int t = 0; t < nWorkers; ++t) pool.emplace_back(worker);
+  for (auto& th : pool) th.join();
+
+  const auto t0 = std::chrono::steady_clock::now();
+  merger.reset();   // the merger writes the last queued buffers and closes the file
+  total.seconds[h2r::kWrite] += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+  if (ctx.report) ctx.report->addOutput(args.outRoot.Data());
+  return total;
+}
+
+// --- Sharded path: inputs not yet covered by <shardDir>/manifest.tsv are converted
+//     into shard_NNNNN.root files of filesPerShard inputs each. A shard is written
+//     under a temporary name and only enters the manifest once it is complete, so
+//     re-running after a crash or after appending to the list resumes where it left off.
+template <class Schema>
+static FileStats ConvertSharded(const Args& args, const std::vector<std::string>& data, const RunContext& ctx) {
+  gSystem->mkdir(args.shardDir, true);
+  h2r::ShardManifest manifest(args.shardDir.Data());
+  manifest.load();
+  const std::vector<h2r::ShardManifest::Shard> todo = manifest.plan(data, args.filesPerShard);
+  std::cout << "Shards: " << manifest.inputCount() << " inputs up to date, "
+            << todo.size() << " shard(s) to convert\n";
+
+  std::atomic<size_t> nextShard{0};
+  std::mutex          totalMutex;
+  FileStats           total;
+
+  auto worker = [&]() {
+    for (size_t k; (k = nextShard++) < todo.size();) {
+      const auto& shard   = todo[k];
+      const std::string final_path = manifest.shardPath(shard.name);
+      const std::string tmp_path   = final_path + ".part";
+
+      std::vector<h2r::ShardManifest::Input> done;
+      FileStats shardStats;
+      typename Schema::Row row;
+      double closeSeconds = 0.;
+      const bool ok = WriteOutput<Schema>(tmp_path, args, row, closeSeconds, [&](h2r::RowWriter& out) {
+        for (const auto& filePath : shard.inputs) {
+          // stamped before converting, so a file replaced meanwhile is redone next run
+          h2r::ShardManifest::Input in;
+          in.path = filePath;
+          if (!h2r::ShardManifest::stamp(filePath, in.size, in.mtime)) {
+            std::lock_guard<std::mutex> lock(gLogMutex);
+            std::cerr << "ERROR: cannot stat " << filePath << " (skipping, retried on the next run)\n";
+            continue;
+          }
+          const FileStats st = h2r::ConvertFile<Schema>(filePath, out, row, ctx);
+          shardStats.add(st);
+          in.events = st.events; in.kept = st.kept;
+          done.push_back(in);
+        }
+      });
+      if (!ok) {
+        std::remove(tmp_path.c_str());
+        std::lock_guard<std::mutex> lock(gLogMutex);
+        std::cerr << "ERROR: cannot create shard " << tmp_path << "\n";
+        continue;
+      }
+      if (done.empty()) {   // nothing readable in this shard
+        std::remove(tmp_path.c_str());
+        continue;
+      }
+
+      if (std::rename(tmp_path.c_str(), final_path.c_str()) != 0) {
+        std::remove(tmp_path.c_str());
+        std::lock_guard<std::mutex> lock(gLogMutex);
+        std::cerr << "ERROR: cannot finalize shard " << final_path << "\n";
+        continue;
+      }
+      if (!manifest.commit(shard.name, done)) {
+        // an unrecorded shard would be read by the analysis and converted again next run
+        std::remove(final_path.c_str());
+        std::lock_guard<std::mutex> lock(gLogMutex);
+        std::cerr << "ERROR: cannot record shard " << final_path << " in " << manifest.manifestPath() << "\n";
+        continue;
+      }
+      shardStats.seconds[h2r::kWrite] += closeSeconds;
+      if (ctx.report) ctx.report->addOutput(final_path);
+      std::lock_guard<std::mutex> lock(totalMutex);
+      total.add(shardStats);
+    }
+  };
+
+  if (args.nThreads > 1) {
+    ROOT::EnableThreadSafety();
+    std::vector<std::thread> pool;
+    for (int t = 0; t < std::min<int>(args.nThreads, todo.size()); ++t) pool.emplace_back(worker);
+    for (auto& th : pool) th.join();
+  } else {
+    worker();
+  }
+  return total;
+}
+
+template <class Schema>
+static FileStats Convert(const Args& args, const std::vector<std::string>& data, const RunContext& ctx) {
+  return !args.shardDir.IsNull() ? ConvertSharded<Schema>(args, data, ctx)
+       : (args.nThreads > 1)     ? ConvertParallel<Schema>(args, data, ctx)
+                                 : ConvertSerial<Schema>(args, data, ctx);
+}
 
+void ProcessHipo(const Args& args) {
   // --- Read file list
   std::ifstream flist(args.inList.Data());
   if (!flist.is_open()) {
@@ -134,147 +452,121 @@ void ProcessHipo(const Args& args) {
   std::vector<std::string> data;
   for (std::string s; std::getline(flist, s);) if (!s.empty()) data.push_back(s);
 
-  gBenchmark->Start("timer");
-  std::cout << "Reading HIPO…\n";
-
-  Long64_t total_events = 0;
-  Long64_t total_events_check = 0;
-  Long64_t events_kept = 0;
-
-  for (const auto& filePath : data) {
-    hipo::reader reader;
-    reader.open(filePath.c_str());
-    if (!reader.is_open()) {
-      std::cerr << "WARNING: cannot open " << filePath << " (skipping)\n";
-      continue;
+  // --- Optional input catalog: skip known-bad files up front; files it does
+  //     not know (or that changed since) are converted as usual
+  h2r::InputCatalog catalog;
+  size_t nRejected = 0;
+  if (!args.catalog.IsNull()) {
+    if (!catalog.load(args.catalog.Data())) {
+      std::cerr << "ERROR: cannot read catalog: " << args.catalog << "\n";
+      gSystem->Exit(5);
     }
-    hipo::dictionary dict; reader.readDictionary(dict);
-    if (!dict.hasSchema("REC::Particle") || !dict.hasSchema("MC::Particle")) {
-      std::cerr << "WARNING: required banks missing in " << filePath << " (skipping)\n";
-      continue;
-    }
-
-    hipo::event event;
-    hipo::bank  REC_particle(dict.getSchema("REC::Particle"));
-    hipo::bank  MC_particle (dict.getSchema("MC::Particle"));
-    hipo::bank  REC_track   (dict.getSchema("REC::Track"));
-    hipo::bank  REC_traj    (dict.getSchema("REC::Traj"));
-
-    Long64_t n_this_file = 0;
-
-    while (reader.next()) {
-      reader.read(event);               // <-- read every event (don’t skip the first)
-      ++total_events;
-      ++n_this_file;
-
-      event.getStructure(REC_particle);
-      event.getStructure(MC_particle);
-      event.getStructure(REC_track);
-      event.getStructure(REC_traj);
-
-      const int Nrec = REC_particle.getRows();
-      const int Nmc  = MC_particle.getRows();
-      if (Nrec <= 0 || Nmc <= 0) continue;
-
-      // --- pick one proton/electron in REC
-      int idx_p_rec = -1, idx_e_rec = -1;
-      for (int i = 0; i < Nrec; ++i) {
-        const int pid = REC_particle.getInt("pid", i);
-        if (pid == 2212 && idx_p_rec < 0) idx_p_rec = i;
-        else if (pid == 11 && idx_e_rec < 0) idx_e_rec = i;
-        if (idx_p_rec >= 0 && idx_e_rec >= 0) break;
+    std::vector<std::string> usable;
+    for (const auto& f : data) {
+      if (const char* why = catalog.reject(f, !args.data)) {
+        std::cerr << "WARNING: " << f << " : " << why << " in catalog (skipping)\n";
+        ++nRejected;
+      } else {
+        usable.push_back(f);
       }
-      if (idx_p_rec < 0 || idx_e_rec < 0) continue;
-
-      // --- pick one proton/electron in MC
-      int idx_p_mc = -1, idx_e_mc = -1;
-      for (int i = 0; i < Nmc; ++i) {
-        const int pid = MC_particle.getInt("pid", i);
-        if (pid == 2212 && idx_p_mc < 0) idx_p_mc = i;
-        else if (pid == 11 && idx_e_mc < 0) idx_e_mc = i;
-        if (idx_p_mc >= 0 && idx_e_mc >= 0) break;
-      }
-      if (idx_p_mc < 0 || idx_e_mc < 0) continue;
-
-      // --- reset all per-event sentinels (prevents carry-over)
-      edge1_electron = edge2_electron = edge3_electron = -1.f;
-      edge1_proton   = edge2_proton   = edge3_proton   = -1.f;
-      x1_proton = y1_proton = z1_proton = -1000.f;
-      x1_electron = y1_electron = z1_electron = -1000.f;
-      sector_proton = -1;
-
-      // --- fill proton
-      px_prot_gen = MC_particle.getFloat("px", idx_p_mc);
-      py_prot_gen = MC_particle.getFloat("py", idx_p_mc);
-      pz_prot_gen = MC_particle.getFloat("pz", idx_p_mc);
-      p_proton_gen = std::sqrt(px_prot_gen*px_prot_gen + py_prot_gen*py_prot_gen + pz_prot_gen*pz_prot_gen);
-
-      px_prot_rec = REC_particle.getFloat("px", idx_p_rec);
-      py_prot_rec = REC_particle.getFloat("py", idx_p_rec);
-      pz_prot_rec = REC_particle.getFloat("pz", idx_p_rec);
-      p_proton_rec = std::sqrt(px_prot_rec*px_prot_rec + py_prot_rec*py_prot_rec + pz_prot_rec*pz_prot_rec);
-
-      vx_prot = REC_particle.getFloat("vx", idx_p_rec);
-      vy_prot = REC_particle.getFloat("vy", idx_p_rec);
-      vz_prot = REC_particle.getFloat("vz", idx_p_rec);
-
-      pid_proton    = REC_particle.getInt("pid",    idx_p_rec);
-      status_proton = REC_particle.getInt("status", idx_p_rec);
-
-      // sector from REC::Track
-      for (int i = 0, Nt = REC_track.getRows(); i < Nt; ++i) {
-        if (REC_track.getInt("pindex", i) == idx_p_rec) {
-          sector_proton = REC_track.getInt("sector", i);
-          break;
-        }
-      }
-
-      // --- fill electron
-      px_electron_gen = MC_particle.getFloat("px", idx_e_mc);
-      py_electron_gen = MC_particle.getFloat("py", idx_e_mc);
-      pz_electron_gen = MC_particle.getFloat("pz", idx_e_mc);
-      p_electron_gen = std::sqrt(px_electron_gen*px_electron_gen + py_electron_gen*py_electron_gen + pz_electron_gen*pz_electron_gen);
-
-      px_electron_rec = REC_particle.getFloat("px", idx_e_rec);
-      py_electron_rec = REC_particle.getFloat("py", idx_e_rec);
-      pz_electron_rec = REC_particle.getFloat("pz", idx_e_rec);
-      p_electron_rec = std::sqrt(px_electron_rec*px_electron_rec + py_electron_rec*py_electron_rec + pz_electron_rec*pz_electron_rec);
-
-      pid_electron    = REC_particle.getInt("pid",    idx_e_rec);
-      status_electron = REC_particle.getInt("status", idx_e_rec);
-
-      // --- DC traj (detector 6), grab layer 6/18/36 and DC1 xyz
-      for (int i = 0, Ntj = REC_traj.getRows(); i < Ntj; ++i) {
-        if (REC_traj.getInt("detector", i) != 6) continue;
-        const int pidx  = REC_traj.getInt("pindex", i);
-        const int layer = REC_traj.getInt("layer",  i);
-        const float edge = REC_traj.getFloat("edge", i);
-
-        if (pidx == idx_e_rec) {
-          if (layer == 6)  { edge1_electron = edge; x1_electron = REC_traj.getFloat("x", i); y1_electron = REC_traj.getFloat("y", i); z1_electron = REC_traj.getFloat("z", i); }
-          if (layer == 18) edge2_electron = edge;
-          if (layer == 36) edge3_electron = edge;
-        } else if (pidx == idx_p_rec) {
-          if (layer == 6)  { edge1_proton   = edge; x1_proton   = REC_traj.getFloat("x", i); y1_proton   = REC_traj.getFloat("y", i); z1_proton   = REC_traj.getFloat("z", i); }
-          if (layer == 18) edge2_proton   = edge;
-          if (layer == 36) edge3_proton   = edge;
-        }
-      }
-
-      out_tree.Fill();
-      ++events_kept;
-    } // while events
+    }
+    data.swap(usable);
+    // the worker pool pulls files in list order: start with the most events so no
+    // long file is left for the end (output row order is scheduling-dependent there anyway);
+    // counts are looked up once, each lookup stats the file
+    if (args.nThreads > 1 && args.shardDir.IsNull()) {
+      std::vector<std::pair<long long, std::string>> byEvents;
+      for (auto& f : data) byEvents.emplace_back(catalog.events(f), std::move(f));
+      std::stable_sort(byEvents.begin(), byEvents.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+      for (size_t i = 0; i < data.size(); ++i) data[i] = std::move(byEvents[i].second);
+    }
+    std::cout << "Catalog: " << args.catalog << " (" << nRejected << " input(s) skipped)\n";
+  }
 
-    std::cout << filePath << " : " << n_this_file << " events\n";
-    total_events_check += n_this_file;
-  } // for files
+  // --- Optional skim index in/out; an index only serves runs with the selection
+  //     (mode and schema) it was written with
+  const std::string modeName   = args.data ? "data" : "mc";
+  const std::string schemaName = args.schema == h2r::SchemaKind::kMulti ? "multi" : "scalar";
+  h2r::SkimIndex skimIn, skimOut;
+  skimOut.mode   = modeName;
+  skimOut.schema = schemaName;
+  RunContext ctx;
+  if (!args.skimIn.IsNull()) {
+    if (!skimIn.load(args.skimIn.Data())) {
+      std::cerr << "ERROR: cannot read skim index: " << args.skimIn << "\n";
+      gSystem->Exit(4);
+    }
+    if (const char* why = skimIn.mismatch(modeName, schemaName)) {
+      std::cerr << "ERROR: skim index " << args.skimIn << " " << why << " (index: mode=" << skimIn.mode
+                << " schema=" << skimIn.schema << ", this run: mode=" << modeName << " schema=" << schemaName
+                << "); write a new one with --skim-out\n";
+      gSystem->Exit(4);
+    }
+    std::cout << "Skim index: " << args.skimIn << " (" << skimIn.size() << " files)\n";
+    ctx.skimIn = &skimIn;
+  }
+  if (!args.skimOut.IsNull()) ctx.skimOut = &skimOut;
+  ctx.readAhead = args.readAhead;
+  ctx.prefetchBytes = args.prefetchMB > 0 ? static_cast<size_t>(args.prefetchMB) << 20 : 0;
+
+  // --- Run report (always written) and optional progress line
+  h2r::RunReport report;
+  report.info = {
+    {"input_list", args.inList.Data()},
+    {"mode",       modeName},
+    {"schema",     schemaName},
+    {"format",     args.format == h2r::Format::kRNTuple ? "rntuple" : "ttree"},
+    {"threads",    std::to_string(args.nThreads)},
+    {"read_ahead", std::to_string(args.readAhead)},
+    {"mmap_window_mb", std::to_string(args.prefetchMB)},
+    {"catalog",    args.catalog.Data()},
+    {"precision",  args.precisionSpec.Data()},
+    {"mem_budget_mb", std::to_string(args.memBudgetMB)},
+    {"max_output_mb", std::to_string(args.maxOutputMB)},
+    {"catalog_skipped", std::to_string(nRejected)},
+  };
+  if (args.progress > 0) {
+    long long totalBytes = 0;
+    for (const auto& f : data) totalBytes += std::max(0LL, h2r::fileSize(f));
+    report.startProgress(args.progress, data.size(), totalBytes);
+  }
+  ctx.report = &report;
 
-  outFile.Write();
-  outFile.Close();
+  gBenchmark->Start("timer");
+  const auto start = std::chrono::steady_clock::now();
+  std::cout << "Reading HIPO…" << (args.nThreads > 1 ? Form(" (%d threads)", args.nThreads) : "") << "\n";
+
+  auto convert = [&](auto mode) {
+    using Mode = decltype(mode);
+    return args.schema == h2r::SchemaKind::kMulti ? Convert<h2r::MultiSchema<Mode>>(args, data, ctx)
+                                                  : Convert<h2r::ScalarSchema<Mode>>(args, data, ctx);
+  };
+  const FileStats total = args.data ? convert(h2r::DataMode{}) : convert(h2r::McMode{});
+
+  if (ctx.skimOut) {
+    if (skimOut.save(args.skimOut.Data())) std::cout << "Wrote skim index: " << args.skimOut << "\n";
+    else std::cerr << "ERROR: cannot write skim index: " << args.skimOut << "\n";
+  }
 
-  std::cout << "Wrote data into: " << args.outRoot << "\n";
-  std::cout << "Total events (streamed)    : " << total_events << "\n";
-  std::cout << "Total events (per-file sum): " << total_events_check << "\n";
-  std::cout << "Events kept (rec+mc e&p)   : " << events_kept << "\n";
+  std::cout << "Wrote data into: " << (args.shardDir.IsNull() ? args.outRoot : args.shardDir) << "\n";
+  std::cout << "Total events (streamed)    : " << total.events << "\n";
+  std::cout << "Events kept                : " << total.kept << "\n";
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::cout << "Event rate (streamed)      : " << total.events / elapsed.count() << " ev/s\n";
+
+  // staged decoding savings; the time is extrapolated from the mean decode cost
+  const double perEvent = total.lateDecoded > 0 ? total.lateSeconds / total.lateDecoded : 0.;
+  std::cout << "Track/Traj decoded (events): " << total.lateDecoded
+            << " (" << total.bytesDecoded / 1048576. << " MB, " << total.lateSeconds << " s)\n";
+  std::cout << "Track/Traj skipped (events): " << total.lateSkipped
+            << " (" << total.bytesSkipped / 1048576. << " MB, ~" << perEvent * total.lateSkipped << " s saved)\n";
+
+  // per-stage time, summed over threads
+  std::cout << "Stage time [s]            :";
+  for (int i = 0; i < h2r::kNumStages; ++i) std::cout << " " << h2r::stageName(i) << "=" << total.seconds[i];
+  std::cout << "\n";
+  std::cout << "Peak RSS                   : " << h2r::peakRssKB() / 1024. << " MB\n";
+  if (report.write(args.report.Data(), total)) std::cout << "Wrote run report: " << args.report << "\n";
+  else std::cerr << "ERROR: cannot write run report: " << args.report << "\n";
   gBenchmark->Show("timer");
 }
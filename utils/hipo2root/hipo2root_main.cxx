@@ -0,0 +1,19 @@
+// Compiled hipo2root: the same core and options as the macro, built with
+// optimization and without interpreter startup.
+//
+// to build, use (clas12root environment loaded; $HIPO is the hipo4 install,
+// older clas12root trees have it in $CLAS12ROOT/hipo4). No -march=native: the
+// binary built on a login node has to run on every farm node:
+//g++ -O3 -std=c++17 hipo2root_main.cxx -o hipo2root `root-config --cflags --glibs` -lROOTNTuple -I$CLAS12ROOT/Clas12Banks -I$HIPO/include -L$CLAS12ROOT/lib -L$HIPO/lib -lClas12Banks -lhipo4 -llz4 -lpthread
+//
+//   ./hipo2root --in=<filelist.dat> [--out=output.root] [any hipo2root.c option]
+//   ./hipo2root --data --in=<runs.dat> ...        (what hipo2rootExp.c runs)
+
+#include "hipo2root.c"
+
+int main(int argc, char** argv) {
+  if (!gBenchmark) gBenchmark = new TBenchmark();   // set up by the interpreter in the macro case
+  auto args = parse_args(argc, argv);
+  ProcessHipo(args);
+  return 0;
+}
@@ -0,0 +1,101 @@
+#pragma once
+// Typed views over the HIPO banks the converters read.
+//
+// hipo::bank::getInt/getFloat(const char*, row) look the column name up in the
+// schema on every call. The views below resolve each column to its index once,
+// when the bank is created from the file's dictionary, and the event loop then
+// goes through getInt/getFloat(item, row).
+
+#include "clas12reader.h"
+
+namespace h2r {
+
+// Payload bytes of bank `b` in `event`, read from the structure header without
+// copying the bank out; 0 when the event does not carry it.
+inline int bankBytes(hipo::event& event, hipo::bank& b) {
+  hipo::schema& s = b.getSchema();
+  return event.getStructurePosition(s.getGroup(), s.getItem()).second;
+}
+
+class RecParticleBank {
+ public:
+  explicit RecParticleBank(hipo::schema& s)
+      : bank(s),
+        c_pid_(s.getEntryOrder("pid")), c_status_(s.getEntryOrder("status")),
+        c_px_(s.getEntryOrder("px")), c_py_(s.getEntryOrder("py")), c_pz_(s.getEntryOrder("pz")),
+        c_vx_(s.getEntryOrder("vx")), c_vy_(s.getEntryOrder("vy")), c_vz_(s.getEntryOrder("vz")) {}
+
+  int   rows()        const { return bank.getRows(); }
+  int   pid(int i)    const { return bank.getInt(c_pid_, i); }
+  int   status(int i) const { return bank.getInt(c_status_, i); }
+  float px(int i)     const { return bank.getFloat(c_px_, i); }
+  float py(int i)     const { return bank.getFloat(c_py_, i); }
+  float pz(int i)     const { return bank.getFloat(c_pz_, i); }
+  float vx(int i)     const { return bank.getFloat(c_vx_, i); }
+  float vy(int i)     const { return bank.getFloat(c_vy_, i); }
+  float vz(int i)     const { return bank.getFloat(c_vz_, i); }
+
+  hipo::bank bank;
+
+ private:
+  int c_pid_, c_status_, c_px_, c_py_, c_pz_, c_vx_, c_vy_, c_vz_;
+};
+
+class McParticleBank {
+ public:
+  explicit McParticleBank(hipo::schema& s)
+      : bank(s),
+        c_pid_(s.getEntryOrder("pid")),
+        c_px_(s.getEntryOrder("px")), c_py_(s.getEntryOrder("py")), c_pz_(s.getEntryOrder("pz")) {}
+
+  int   rows()     const { return bank.getRows(); }
+  int   pid(int i) const { return bank.getInt(c_pid_, i); }
+  float px(int i)  const { return bank.getFloat(c_px_, i); }
+  float py(int i)  const { return bank.getFloat(c_py_, i); }
+  float pz(int i)  const { return bank.getFloat(c_pz_, i); }
+
+  hipo::bank bank;
+
+ private:
+  int c_pid_, c_px_, c_py_, c_pz_;
+};
+
+class RecTrackBank {
+ public:
+  explicit RecTrackBank(hipo::schema& s)
+      : bank(s), c_pindex_(s.getEntryOrder("pindex")), c_sector_(s.getEntryOrder("sector")) {}
+
+  int rows()        const { return bank.getRows(); }
+  int pindex(int i) const { return bank.getInt(c_pindex_, i); }
+  int sector(int i) const { return bank.getInt(c_sector_, i); }
+
+  hipo::bank bank;
+
+ private:
+  int c_pindex_, c_sector_;
+};
+
+class RecTrajBank {
+ public:
+  explicit RecTrajBank(hipo::schema& s)
+      : bank(s),
+        c_pindex_(s.getEntryOrder("pindex")), c_detector_(s.getEntryOrder("detector")),
+        c_layer_(s.getEntryOrder("layer")), c_edge_(s.getEntryOrder("edge")),
+        c_x_(s.getEntryOrder("x")), c_y_(s.getEntryOrder("y")), c_z_(s.getEntryOrder("z")) {}
+
+  int   rows()          const { return bank.getRows(); }
+  int   pindex(int i)   const { return bank.getInt(c_pindex_, i); }
+  int   detector(int i) const { return bank.getInt(c_detector_, i); }
+  int   layer(int i)    const { return bank.getInt(c_layer_, i); }
+  float edge(int i)     const { return bank.getFloat(c_edge_, i); }
+  float x(int i)        const { return bank.getFloat(c_x_, i); }
+  float y(int i)        const { return bank.getFloat(c_y_, i); }
+  float z(int i)        const { return bank.getFloat(c_z_, i); }
+
+  hipo::bank bank;
+
+ private:
+  int c_pindex_, c_detector_, c_layer_, c_edge_, c_x_, c_y_, c_z_;
+};
+
+} // namespace h2r
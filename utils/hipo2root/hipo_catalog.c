@@ -0,0 +1,72 @@
+// Pre-scan of a HIPO file list: existence, size, schemas, record and event
+// counts of every input, read from headers and dictionaries only.
+//   clas12root -q -b hipo_catalog.c --in=andrey_runs_FULL.dat [--out=list.catalog.tsv] [--threads=N]
+// Re-running reuses the entries of files that did not change. Feed the result
+// to the converter (hipo2root.c --catalog=...) and to shard_convert.py --catalog.
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <TSystem.h>
+#include <TApplication.h>
+#include "input_catalog.h"
+
+void hipo_catalog() {
+  TString inList, out;
+  int nThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (Int_t i = 1; i < gApplication->Argc(); ++i) {
+    TString opt = gApplication->Argv(i);
+    if (opt.BeginsWith("--in="))           inList = opt(5, opt.Length() - 5);
+    else if (opt.BeginsWith("--out="))     out = opt(6, opt.Length() - 6);
+    else if (opt.BeginsWith("--threads=")) nThreads = TString(opt(10, opt.Length() - 10)).Atoi();
+    else if (opt.EndsWith(".dat") || opt.EndsWith(".txt")) inList = opt;
+  }
+  if (inList.IsNull()) {
+    std::cerr << "Usage: clas12root -q -b hipo_catalog.c --in=<filelist.dat> [--out=list.catalog.tsv] [--threads=N]\n";
+    gSystem->Exit(1);
+  }
+  if (out.IsNull()) out = inList + ".catalog.tsv";
+
+  std::ifstream flist(inList.Data());
+  if (!flist.is_open()) {
+    std::cerr << "ERROR: cannot open list file: " << inList << "\n";
+    gSystem->Exit(3);
+  }
+  std::vector<std::string> files;
+  for (std::string s; std::getline(flist, s);) if (!s.empty()) files.push_back(s);
+
+  const auto start = std::chrono::steady_clock::now();
+  h2r::InputCatalog catalog;
+  catalog.load(out.Data());
+  const size_t probed = catalog.scan(files, nThreads);
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  long long count[h2r::InputCatalog::kNumStatus] = {}, events = 0, bytes = 0, noRec = 0, noMc = 0;
+  for (const auto& kv : catalog.entries()) {
+    const auto& e = kv.second;
+    ++count[e.status];
+    if (e.status != h2r::InputCatalog::kOk) {
+      std::cout << "  " << h2r::InputCatalog::statusName(e.status) << "\t" << e.path << "\n";
+      continue;
+    }
+    events += e.events;
+    bytes  += e.size;
+    if (!e.rec) { ++noRec; std::cout << "  no REC::Particle\t" << e.path << "\n"; }
+    else if (!e.mc) ++noMc;
+  }
+
+  std::cout << "Files                      : " << files.size() << " (" << probed << " probed, "
+            << files.size() - probed << " unchanged, " << elapsed.count() << " s, " << nThreads << " threads)\n";
+  std::cout << "Status                     :";
+  for (int s = 0; s < h2r::InputCatalog::kNumStatus; ++s) std::cout << " " << h2r::InputCatalog::statusName(s) << "=" << count[s];
+  std::cout << "\n";
+  std::cout << "Without REC::Particle      : " << noRec << "\n";
+  std::cout << "Without MC::Particle (data): " << noMc << "\n";
+  std::cout << "Events / size (ok files)   : " << events << " / " << bytes / 1073741824. << " GB\n";
+  if (catalog.save(out.Data())) std::cout << "Wrote catalog: " << out << "\n";
+  else {
+    std::cerr << "ERROR: cannot write catalog: " << out << "\n";
+    gSystem->Exit(2);
+  }
+}
@@ -0,0 +1,196 @@
+#pragma once
+// RDataFrame straight from HIPO files, without an intermediate ROOT file.
+//
+// HipoDataSource<Schema> exposes a schema's output columns (schemas.h) as
+// RDataFrame columns. Every event of the file list is one entry. An entry the
+// schema does not select is skipped by returning false from SetEntry(), so the
+// frame sees exactly the rows hipo2root would have written. Entry ranges are
+// chunks of at most `chunk` events inside one file. Under ImplicitMT each slot
+// has its own reader, banks and row, and jumps within a file with gotoEvent().
+// Event counts come from an InputCatalog (input_catalog.h): MakeHipoDataFrame
+// reuses <list>.catalog.tsv from hipo_catalog.c where it is still valid and
+// probes the other files in parallel.
+//
+//   auto rdf = h2r::MakeHipoDataFrame("runs.dat", /*mc=*/true);
+//
+// The analysis executables pick this up for .dat/.txt inputs when built with
+// -DH2R_WITH_HIPO (see analysis/dataset.cxx).
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+#include <ROOT/RDataFrame.hxx>
+#include <ROOT/RDataSource.hxx>
+
+#include "input_catalog.h"
+#include "schemas.h"
+
+namespace h2r {
+
+template <class Schema>
+class HipoDataSource final : public ROOT::RDF::RDataSource {
+  using Mode = typename Schema::Mode;
+  using Row  = typename Schema::Row;
+
+ public:
+  // Probes `files` itself; see the next constructor.
+  explicit HipoDataSource(std::vector<std::string> files, ULong64_t chunk = 100000)
+      : HipoDataSource(files, Scanned(files), chunk) {}
+
+  // `catalog` holds the entries of `files` (InputCatalog::scan). Files it
+  // rejects for the schema's mode, or that changed since, contribute no entries.
+  HipoDataSource(std::vector<std::string> files, const InputCatalog& catalog, ULong64_t chunk = 100000)
+      : files_(std::move(files)) {
+    for (const auto& c : Schema::columns()) {
+      names_.emplace_back(c.name);
+      types_.emplace_back(c.vec ? (c.type == 'F' ? "std::vector<float>" : "std::vector<int>")
+                                : (c.type == 'F' ? "float" : "int"));
+    }
+
+    offsets_.push_back(0);
+    for (const auto& path : files_) {
+      const ULong64_t n = catalog.reject(path, Mode::kMC) ? 0 : std::max(0LL, catalog.events(path));
+      for (ULong64_t first = 0; first < n; first += chunk) {
+        allRanges_.emplace_back(offsets_.back() + first, offsets_.back() + std::min(n, first + chunk));
+      }
+      offsets_.push_back(offsets_.back() + n);
+    }
+  }
+
+  void SetNSlots(unsigned int nSlots) override {
+    slots_.clear();
+    for (unsigned int i = 0; i < nSlots; ++i) slots_.push_back(std::make_unique<SlotState>());
+    addresses_.assign(names_.size(), std::vector<void*>(nSlots));
+    const auto& cols = Schema::columns();
+    for (size_t c = 0; c < cols.size(); ++c)
+      for (unsigned int s = 0; s < nSlots; ++s)
+        addresses_[c][s] = reinterpret_cast<char*>(&slots_[s]->row) + cols[c].offset;
+  }
+
+  const std::vector<std::string>& GetColumnNames() const override { return names_; }
+
+  bool HasColumn(std::string_view name) const override {
+    return std::find(names_.begin(), names_.end(), name) != names_.end();
+  }
+
+  std::string GetTypeName(std::string_view name) const override { return types_[index(name)]; }
+
+  std::vector<std::pair<ULong64_t, ULong64_t>> GetEntryRanges() override {
+    return std::exchange(ranges_, {});   // everything in the first call of an event loop
+  }
+
+  bool SetEntry(unsigned int slot, ULong64_t entry) override {
+    SlotState& s = *slots_[slot];
+    const size_t f = std::upper_bound(offsets_.begin(), offsets_.end(), entry) - offsets_.begin() - 1;
+    if (static_cast<long long>(f) != s.file) open(s, f);
+
+    // sequential entries go through next(), jumps through the record index
+    const long long ev = static_cast<long long>(entry - offsets_[f]);
+    if (!(ev == s.next ? s.reader->next() : s.reader->gotoEvent(ev))) return false;
+    s.next = ev + 1;
+    s.reader->read(s.event);
+
+    // same two stages as ConvertFile(), without the accounting
+    EventBanks<Mode>& b = *s.banks;
+    s.event.getStructure(b.REC_particle.bank);
+    if constexpr (Mode::kMC) s.event.getStructure(b.MC_particle.bank);
+    if (!Schema::select(b, s.pick)) return false;
+
+    s.event.getStructure(b.REC_track.bank);
+    s.event.getStructure(b.REC_traj.bank);
+    s.assoc.build(b.REC_track, b.REC_traj, b.REC_particle.rows());
+    return Schema::fill(b, s.assoc, s.pick, s.row);
+  }
+
+  void Initialize() override { ranges_ = allRanges_; }
+  void Finalize() override {
+    for (auto& s : slots_) { s->reader.reset(); s->file = -1; }   // close the files between event loops
+  }
+
+  std::string GetLabel() override { return "HipoDS"; }
+
+ protected:
+  Record_t GetColumnReadersImpl(std::string_view name, const std::type_info& ti) override {
+    const size_t c = index(name);
+    const Column& col = Schema::columns()[c];
+    const std::type_info& expected = col.vec ? (col.type == 'F' ? typeid(std::vector<float>) : typeid(std::vector<int>))
+                                             : (col.type == 'F' ? typeid(float) : typeid(int));
+    if (ti != expected) {
+      throw std::runtime_error("HipoDS: column " + std::string(name) + " has type " + types_[c]);
+    }
+    Record_t readers;
+    for (auto& a : addresses_[c]) readers.push_back(&a);   // RDataFrame reads through T**
+    return readers;
+  }
+
+ private:
+  struct SlotState {
+    std::unique_ptr<hipo::reader>      reader;
+    std::unique_ptr<hipo::dictionary>  dict;
+    std::unique_ptr<EventBanks<Mode>>  banks;
+    ParticleIndex                      assoc;
+    typename Schema::Pick              pick{};
+    hipo::event                        event;
+    Row                                row{};
+    long long                          file = -1;
+    long long                          next = 0;   // event next() would return
+  };
+
+  // Catalog of `files` probed with one reader per hardware thread.
+  static InputCatalog Scanned(const std::vector<std::string>& files) {
+    InputCatalog catalog;
+    catalog.scan(files, std::max(1u, std::thread::hardware_concurrency()));
+    return catalog;
+  }
+
+  void open(SlotState& s, size_t f) const {
+    s.reader = std::make_unique<hipo::reader>();
+    s.reader->open(files_[f].c_str());
+    s.dict = std::make_unique<hipo::dictionary>();
+    s.reader->readDictionary(*s.dict);
+    s.banks = std::make_unique<EventBanks<Mode>>(*s.dict);
+    s.file = static_cast<long long>(f);
+    s.next = 0;
+  }
+
+  size_t index(std::string_view name) const {
+    const auto it = std::find(names_.begin(), names_.end(), name);
+    if (it == names_.end()) throw std::runtime_error("HipoDS: no column " + std::string(name));
+    return it - names_.begin();
+  }
+
+  std::vector<std::string>                      files_;
+  std::vector<ULong64_t>                        offsets_;    // first entry of each file, plus the total
+  std::vector<std::pair<ULong64_t, ULong64_t>>  allRanges_, ranges_;   // ranges_: left for this event loop
+  std::vector<std::string>                      names_, types_;
+  std::vector<std::unique_ptr<SlotState>>       slots_;
+  std::vector<std::vector<void*>>               addresses_;  // [column][slot] -> row member
+};
+
+// RDataFrame over the HIPO files listed in `list` (one per line, '#' comments),
+// with the scalar schema's columns: the same names and rows as a hipo2root
+// conversion. A <list>.catalog.tsv next to the list saves probing unchanged files.
+inline ROOT::RDataFrame MakeHipoDataFrame(const std::string& list, bool mc) {
+  std::vector<std::string> files;
+  std::ifstream in(list);
+  for (std::string s; std::getline(in, s);) {
+    s.erase(0, s.find_first_not_of(" \t"));
+    s.erase(s.find_last_not_of(" \t\r") + 1);
+    if (!s.empty() && s[0] != '#') files.push_back(s);
+  }
+  InputCatalog catalog;
+  catalog.load(list + ".catalog.tsv");   // optional
+  catalog.scan(files, std::max(1u, std::thread::hardware_concurrency()));
+  if (mc) return ROOT::RDataFrame(std::make_unique<HipoDataSource<ScalarSchema<McMode>>>(std::move(files), catalog));
+  return ROOT::RDataFrame(std::make_unique<HipoDataSource<ScalarSchema<DataMode>>>(std::move(files), catalog));
+}
+
+} // namespace h2r
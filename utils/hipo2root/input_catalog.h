@@ -0,0 +1,163 @@
+#pragma once
+// Catalog of the HIPO inputs of a file list (hipo_catalog.c, --catalog).
+//
+// probe() opens a file and reads only its header, record index and schema
+// dictionary: no event is decompressed. scan() probes a list with a pool of
+// threads, each with its own reader. The converter uses the catalog to drop
+// files it would otherwise only find to be bad mid-run, and to start the
+// files with the most events first; shard_convert.py balances shards on its
+// event counts.
+// An entry is only trusted while the file's size and mtime still match.
+//
+// <list>.catalog.tsv, one line per input:
+//   path  size  mtime  status  rec  mc  track  traj  records  events
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "clas12reader.h"
+
+namespace h2r {
+
+class InputCatalog {
+ public:
+  enum Status { kOk, kMissing, kUnreadable, kEmpty, kNumStatus };
+
+  static const char* statusName(int s) {
+    static const char* names[kNumStatus] = {"ok", "missing", "unreadable", "empty"};
+    return names[s];
+  }
+
+  struct Entry {
+    std::string path;
+    long long   size    = -1;
+    long long   mtime   = -1;
+    Status      status  = kMissing;
+    bool        rec = false, mc = false, track = false, traj = false;   // schemas in the dictionary
+    long long   records = 0;
+    long long   events  = 0;
+  };
+
+  static Entry probe(const std::string& path) {
+    Entry e;
+    e.path = path;
+    struct stat sb;
+    if (stat(path.c_str(), &sb) != 0) return e;
+    e.size  = static_cast<long long>(sb.st_size);
+    e.mtime = static_cast<long long>(sb.st_mtime);
+
+    if (e.size == 0) { e.status = kEmpty; return e; }
+    e.status = kUnreadable;
+    hipo::reader reader;
+    reader.open(path.c_str());
+    if (!reader.is_open()) return e;
+    hipo::dictionary dict; reader.readDictionary(dict);
+    e.rec   = dict.hasSchema("REC::Particle");
+    e.mc    = dict.hasSchema("MC::Particle");
+    e.track = dict.hasSchema("REC::Track");
+    e.traj  = dict.hasSchema("REC::Traj");
+    e.records = reader.getNRecords();
+    e.events  = reader.getEntries();
+    e.status  = e.events > 0 ? kOk : kEmpty;
+    return e;
+  }
+
+  // Probe `files` with `nThreads` readers; entries still valid from a loaded
+  // catalog are kept as they are. Returns the number of files probed.
+  size_t scan(const std::vector<std::string>& files, int nThreads) {
+    std::vector<Entry> out(files.size());
+    std::vector<size_t> todo;
+    for (size_t i = 0; i < files.size(); ++i) {
+      if (const Entry* e = lookup(files[i])) out[i] = *e;
+      else todo.push_back(i);
+    }
+
+    std::atomic<size_t> next{0};
+    auto worker = [&]() {
+      for (size_t k; (k = next++) < todo.size();) out[todo[k]] = probe(files[todo[k]]);
+    };
+    std::vector<std::thread> pool;
+    for (int t = 0; t < std::min<int>(std::max(nThreads, 1), todo.size()); ++t) pool.emplace_back(worker);
+    for (auto& th : pool) th.join();
+
+    entries_.clear();
+    for (auto& e : out) entries_[e.path] = std::move(e);
+    return todo.size();
+  }
+
+  // The entry for `path` if the file is unchanged since it was catalogued.
+  const Entry* lookup(const std::string& path) const {
+    auto it = entries_.find(path);
+    if (it == entries_.end()) return nullptr;
+    struct stat sb;
+    const bool exists = stat(path.c_str(), &sb) == 0;
+    if (it->second.status == kMissing) return exists ? nullptr : &it->second;
+    if (!exists || sb.st_size != it->second.size || sb.st_mtime != it->second.mtime) return nullptr;
+    return &it->second;
+  }
+
+  // Why `path` cannot be converted in MC (`mc`) or data mode, nullptr if it can
+  // or if the catalog does not know the file (it is then converted as usual).
+  const char* reject(const std::string& path, bool mc) const {
+    const Entry* e = lookup(path);
+    if (!e) return nullptr;
+    if (e->status != kOk) return statusName(e->status);
+    if (!e->rec) return "no REC::Particle";
+    if (mc && !e->mc) return "no MC::Particle";
+    return nullptr;
+  }
+
+  long long events(const std::string& path) const {
+    const Entry* e = lookup(path);
+    return e ? e->events : -1;
+  }
+
+  const std::map<std::string, Entry>& entries() const { return entries_; }
+
+  bool load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    for (std::string line; std::getline(in, line);) {
+      if (line.empty() || line[0] == '#') continue;
+      std::istringstream ls(line);
+      Entry e; std::string status;
+      std::getline(ls, e.path, '\t');
+      ls >> e.size >> e.mtime >> status >> e.rec >> e.mc >> e.track >> e.traj >> e.records >> e.events;
+      if (!ls || e.path.empty()) continue;
+      for (int s = 0; s < kNumStatus; ++s) if (status == statusName(s)) e.status = static_cast<Status>(s);
+      entries_[e.path] = e;
+    }
+    return true;
+  }
+
+  bool save(const std::string& path) const {
+    const std::string tmp = path + ".tmp";
+    {
+      std::ofstream out(tmp);
+      if (!out.is_open()) return false;
+      out << "# path\tsize\tmtime\tstatus\trec\tmc\ttrack\ttraj\trecords\tevents\n";
+      for (const auto& kv : entries_) {
+        const Entry& e = kv.second;
+        out << e.path << '\t' << e.size << '\t' << e.mtime << '\t' << statusName(e.status) << '\t'
+            << e.rec << '\t' << e.mc << '\t' << e.track << '\t' << e.traj << '\t'
+            << e.records << '\t' << e.events << '\n';
+      }
+      if (!out) return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+  }
+
+ private:
+  std::map<std::string, Entry> entries_;
+};
+
+} // namespace h2r
@@ -0,0 +1,90 @@
+#pragma once
+// Kernel read-ahead hints for a HIPO input file.
+//
+// hipo::reader reads records through its own buffered stream, so the converter
+// cannot hand it mapped pages. What it can do is keep the page cache ahead of
+// the reader: the file is mmap()ed read-only with MADV_SEQUENTIAL, and
+// advance() issues MADV_WILLNEED for the next `window` bytes past the reader's
+// estimated position, so large records are already resident when the reader
+// asks for them. If the mapping fails (e.g. on some network mounts),
+// posix_fadvise() on the descriptor is used instead; if that fails too the
+// hints are silently off.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+
+namespace h2r {
+
+class InputHints {
+ public:
+  enum Kind { kOff, kMmap, kFadvise };
+
+  InputHints(const std::string& path, size_t window) : window_(window) {
+    if (window_ == 0) return;
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) return;
+    struct stat sb;
+    if (fstat(fd_, &sb) != 0 || sb.st_size <= 0) return;
+    size_ = static_cast<size_t>(sb.st_size);
+
+    void* p = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (p != MAP_FAILED) {
+      map_  = static_cast<char*>(p);
+      kind_ = kMmap;
+      madvise(map_, size_, MADV_SEQUENTIAL);
+    } else if (posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL) == 0) {
+      kind_ = kFadvise;
+    }
+    advance(0.);
+  }
+
+  ~InputHints() {
+    if (map_) munmap(map_, size_);
+    if (fd_ >= 0) ::close(fd_);
+  }
+
+  InputHints(const InputHints&) = delete;
+  InputHints& operator=(const InputHints&) = delete;
+
+  Kind kind() const { return kind_; }
+
+  // The reader is about `fraction` (0..1) through the file: make sure the
+  // next window is requested. Cheap when the window is already covered.
+  void advance(double fraction) {
+    if (kind_ == kOff) return;
+    const size_t pos = static_cast<size_t>(std::clamp(fraction, 0., 1.) * size_);
+    if (pos + window_ / 2 < requested_ && requested_ > 0) return;   // more than half a window still ahead
+
+    const size_t from = std::max(pos, requested_) & ~(pageSize() - 1);
+    const size_t to   = std::min(size_, pos + window_);
+    if (from >= to) return;
+    if (kind_ == kMmap) madvise(map_ + from, to - from, MADV_WILLNEED);
+    else                posix_fadvise(fd_, from, to - from, POSIX_FADV_WILLNEED);
+    requested_ = to;
+  }
+
+ private:
+  // madvise() wants page-aligned ranges; 64 KiB pages on some aarch64/ppc64le nodes.
+  static size_t pageSize() {
+    static const size_t page = [] {
+      const long n = sysconf(_SC_PAGESIZE);
+      return n > 0 ? static_cast<size_t>(n) : size_t(4096);
+    }();
+    return page;
+  }
+
+  size_t window_;
+  int    fd_   = -1;
+  size_t size_ = 0;
+  char*  map_  = nullptr;
+  Kind   kind_ = kOff;
+  size_t requested_ = 0;   // hints issued up to this offset
+};
+
+} // namespace h2r
@@ -0,0 +1,22 @@
+#pragma once
+// Detector region of a REC::Particle, from its status: the converter's
+// region_proton column and the analysis' region / is_FD / is_CD columns
+// (analysis/kinematics.cxx) both come from regionOf(), so they cannot drift.
+// Kept free of ROOT and hipo so the analysis can include it on its own.
+
+#include <cstdint>
+
+namespace h2r {
+
+enum Region : std::uint8_t { kRegionNA = 0, kRegionFD = 1, kRegionCD = 2 };
+
+// status < 4000 forward (FT/FD), < 8000 central, anything else unassigned.
+inline Region regionOf(int status) {
+  return status < 4000 ? kRegionFD : (status < 8000 ? kRegionCD : kRegionNA);
+}
+
+inline const char* regionName(int region) {
+  return region == kRegionFD ? "FD" : (region == kRegionCD ? "CD" : "NA");
+}
+
+} // namespace h2r
@@ -0,0 +1,159 @@
+#pragma once
+// Output side of the converters: a row struct described by one column table,
+// written either as TTree branches or as RNTuple fields. Columns are float/int
+// scalars or std::vector<float|int> (read back as RVec by RDataFrame).
+//
+// Each converter declares its row as a plain struct plus a table of
+// H2R_COLUMN(Row, member) entries; the table is the single place the output
+// schema is spelled out for both formats.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <RVersion.h>
+#include <ROOT/RNTupleModel.hxx>
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 32, 0)
+#include <ROOT/RNTupleWriter.hxx>
+#else
+#include <ROOT/RNTuple.hxx>
+#endif
+
+namespace h2r {
+
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 34, 0)
+namespace rnt = ROOT;
+#else
+namespace rnt = ROOT::Experimental;
+#endif
+
+template <class T> struct ColumnTraits { using Elem = T; static constexpr bool kVector = false; };
+template <class T> struct ColumnTraits<std::vector<T>> { using Elem = T; static constexpr bool kVector = true; };
+
+struct Column {
+  const char* name;
+  char        type;     // TTree leaf type: 'F' float, 'I' int
+  size_t      offset;   // byte offset inside the row struct
+  bool        vec;      // std::vector<float|int> member, one entry per particle
+  int         bits = 0; // float mantissa bits kept on write, 0 = full precision (precision.h)
+
+  template <class T>
+  static Column of(const char* name, size_t offset) {
+    using E = typename ColumnTraits<T>::Elem;
+    static_assert(std::is_same<E, float>::value || std::is_same<E, int>::value,
+                  "output columns are float or int, or std::vector of those");
+    return Column{name, std::is_same<E, float>::value ? 'F' : 'I', offset, ColumnTraits<T>::kVector};
+  }
+};
+
+#define H2R_COLUMN(Row, member) h2r::Column::of<decltype(Row::member)>(#member, offsetof(Row, member))
+
+enum class Format { kTTree, kRNTuple };
+
+inline bool parseFormat(const std::string& s, Format& f) {
+  if (s == "ttree")   { f = Format::kTTree;   return true; }
+  if (s == "rntuple") { f = Format::kRNTuple; return true; }
+  return false;
+}
+
+// Writes whatever the bound row holds at the time of Fill().
+class RowWriter {
+ public:
+  virtual ~RowWriter() = default;
+  virtual void Fill() = 0;
+  // Compressed bytes of the output so far, including what was still buffered:
+  // that is written out first, so call this between input files, not per row.
+  virtual long long bytesWritten() = 0;
+};
+
+inline void BookBranches(TTree& tree, void* row, const std::vector<Column>& cols) {
+  char* base = static_cast<char*>(row);
+  for (const auto& c : cols) {
+    if (c.vec && c.type == 'F')      tree.Branch(c.name, reinterpret_cast<std::vector<float>*>(base + c.offset));
+    else if (c.vec)                  tree.Branch(c.name, reinterpret_cast<std::vector<int>*>(base + c.offset));
+    else                             tree.Branch(c.name, base + c.offset, (std::string(c.name) + "/" + c.type).c_str());
+  }
+}
+
+class TTreeRowWriter : public RowWriter {
+ public:
+  explicit TTreeRowWriter(TTree& tree) : tree_(tree) {}
+  void Fill() override { tree_.Fill(); }
+  long long bytesWritten() override {
+    tree_.FlushBaskets(false);   // no cluster boundary, AutoFlush keeps placing those
+    const TFile* file = tree_.GetCurrentFile();
+    return file ? file->GetEND() : tree_.GetZipBytes();
+  }
+
+ private:
+  TTree& tree_;
+};
+
+// One RNTuple field per column; Fill() copies the row into the model's entry.
+// The ntuple is committed when the writer is destroyed.
+class RNTupleRowWriter : public RowWriter {
+ public:
+  RNTupleRowWriter(const std::string& path, const std::string& name, const std::vector<Column>& cols,
+                   const void* row, int compress = -1, long long clusterBytes = 0, long long maxUnzippedBytes = 0)
+      : path_(path), row_(static_cast<const char*>(row)) {
+    auto model = rnt::RNTupleModel::Create();
+    for (const auto& c : cols) {
+      void* dst;
+      if (c.vec && c.type == 'F') dst = model->MakeField<std::vector<float>>(c.name).get();
+      else if (c.vec)             dst = model->MakeField<std::vector<int>>(c.name).get();
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 36, 0)
+      else if (c.type == 'F' && c.bits > 0) {
+        // sign + exponent + kept mantissa bits on disk; the row is already rounded
+        auto field = std::make_unique<ROOT::RField<float>>(c.name);
+        field->SetTruncated(9 + c.bits);
+        model->AddField(std::move(field));
+        dst = model->GetDefaultEntry().GetPtr<float>(c.name).get();
+      }
+#endif
+      else if (c.type == 'F')     dst = model->MakeField<float>(c.name).get();
+      else                        dst = model->MakeField<int>(c.name).get();
+      slots_.push_back(Slot{c.offset, dst, c.vec ? c.type : '\0'});
+    }
+    rnt::RNTupleWriteOptions opts;
+    if (compress >= 0) opts.SetCompression(compress);   // -1 keeps the RNTuple default
+    if (clusterBytes > 0) opts.SetApproxZippedClusterSize(clusterBytes);
+    if (maxUnzippedBytes > 0) opts.SetMaxUnzippedClusterSize(std::max(maxUnzippedBytes, clusterBytes));
+    writer_ = rnt::RNTupleWriter::Recreate(std::move(model), name, path, opts);
+  }
+
+  void Fill() override {
+    for (const auto& s : slots_) {
+      const char* src = row_ + s.offset;
+      switch (s.vec) {
+        case 'F': *static_cast<std::vector<float>*>(s.dst) = *reinterpret_cast<const std::vector<float>*>(src); break;
+        case 'I': *static_cast<std::vector<int>*>(s.dst)   = *reinterpret_cast<const std::vector<int>*>(src);   break;
+        default:  std::memcpy(s.dst, src, 4);   // float and int are 4 bytes
+      }
+    }
+    writer_->Fill();
+  }
+
+  long long bytesWritten() override {
+    writer_->CommitCluster();   // pages of the open cluster are only in memory until then
+    struct stat sb;
+    return stat(path_.c_str(), &sb) == 0 ? static_cast<long long>(sb.st_size) : -1;
+  }
+
+ private:
+  struct Slot { size_t offset; void* dst; char vec; };   // vec: element type of a vector column, 0 for scalars
+
+  std::string                          path_;
+  const char*                          row_;
+  std::vector<Slot>                    slots_;    // dst points into the model's default entry
+  std::unique_ptr<rnt::RNTupleWriter>  writer_;
+};
+
+} // namespace h2r
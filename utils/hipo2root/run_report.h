@@ -0,0 +1,221 @@
+#pragma once
+// Per-file and per-stage accounting of a conversion run.
+//
+// ConvertFile() times each stage of its event loop into FileStats and hands
+// the file's stats to the RunReport, which keeps them for the JSON report
+// written next to the output and, with --progress=SEC, prints a periodic
+// events/s + ETA line. Stage times are summed over worker threads.
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace h2r {
+
+// Stages of the conversion, in event-loop order.
+enum Stage { kOpen, kRead, kDecode, kSelect, kFill, kWrite, kNumStages };
+
+inline const char* stageName(int s) {
+  static const char* names[kNumStages] = {"open", "read", "decode", "select", "fill", "write"};
+  return names[s];
+}
+
+inline long long fileSize(const std::string& path) {
+  struct stat sb;
+  return stat(path.c_str(), &sb) == 0 ? static_cast<long long>(sb.st_size) : -1;
+}
+
+// Peak resident set size of the process so far [kB].
+inline long peakRssKB() {
+  struct rusage ru;
+  return getrusage(RUSAGE_SELF, &ru) == 0 ? ru.ru_maxrss : 0;
+}
+
+// Current resident set size of the process [kB], 0 where /proc is not available.
+inline long rssKB() {
+  long pages = 0, resident = 0;
+  if (FILE* f = std::fopen("/proc/self/statm", "r")) {
+    if (std::fscanf(f, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    std::fclose(f);
+  }
+  return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+struct FileStats {
+  long long events = 0;   // events streamed from the file
+  long long kept   = 0;   // rows filled into the tree
+
+  // staged decoding: REC::Track / REC::Traj are only pulled for e+p candidates
+  long long lateDecoded  = 0;    // events whose track/traj banks were decoded
+  long long lateSkipped  = 0;    // events rejected before decoding them
+  long long bytesDecoded = 0;    // track+traj payload copied out
+  long long bytesSkipped = 0;    // track+traj payload left in the event buffer
+  double    lateSeconds  = 0.;   // time spent decoding track+traj
+
+  double    seconds[kNumStages] = {};   // open/dictionary, record read, bank decode, selection, row fill, Fill()+flush
+  long long inputBytes = 0;             // input file size (0 if skipped), not the bytes actually read
+  long      peakRss   = 0;              // process peak RSS after the file [kB]
+  long      rss       = 0;              // process RSS when the file was done [kB]
+
+  void add(const FileStats& o) {
+    events += o.events;             kept += o.kept;
+    lateDecoded += o.lateDecoded;   lateSkipped += o.lateSkipped;
+    bytesDecoded += o.bytesDecoded; bytesSkipped += o.bytesSkipped;
+    lateSeconds += o.lateSeconds;
+    for (int s = 0; s < kNumStages; ++s) seconds[s] += o.seconds[s];
+    inputBytes += o.inputBytes;
+    peakRss = std::max(peakRss, o.peakRss);
+    rss = std::max(rss, o.rss);
+  }
+};
+
+// Accumulates stage time: lap(s) charges the time since the previous lap to stage s.
+class StageClock {
+ public:
+  explicit StageClock(FileStats& st) : st_(st), t_(std::chrono::steady_clock::now()) {}
+  double lap(Stage s) {
+    const auto now = std::chrono::steady_clock::now();
+    const double dt = std::chrono::duration<double>(now - t_).count();
+    st_.seconds[s] += dt;
+    t_ = now;
+    return dt;
+  }
+
+ private:
+  FileStats&                            st_;
+  std::chrono::steady_clock::time_point t_;
+};
+
+class RunReport {
+ public:
+  // Run description written at the top of the report.
+  std::vector<std::pair<std::string, std::string>> info;
+
+  // Progress line every `seconds` (0 = off); the ETA is extrapolated from the
+  // input bytes finished so far against `totalBytes`.
+  void startProgress(double seconds, size_t totalFiles, long long totalBytes) {
+    progressEvery_ = seconds;
+    nextPrint_ = seconds;
+    totalFiles_ = totalFiles;
+    totalBytes_ = totalBytes;
+  }
+
+  // Called from the event loop every few thousand events.
+  void progress(long long newEvents) {
+    events_ += newEvents;
+    if (progressEvery_ <= 0.) return;
+    const double now = elapsed();
+    double next = nextPrint_.load();
+    if (now < next || !nextPrint_.compare_exchange_strong(next, now + progressEvery_)) return;
+
+    const long long done = bytesDone_.load();
+    char eta[32] = "n/a";
+    if (done > 0 && totalBytes_ > 0) {
+      const long s = static_cast<long>(now * (totalBytes_ - done) / done);
+      std::snprintf(eta, sizeof(eta), "%02ld:%02ld:%02ld", s / 3600, s / 60 % 60, s % 60);
+    }
+    std::printf("[progress] files %zu/%zu  events %lld  %.0f ev/s  ETA %s\n",
+                filesDone_.load(), totalFiles_, events_.load(), events_.load() / now, eta);
+    std::fflush(stdout);
+  }
+
+  void addFile(const std::string& path, const FileStats& st) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_.emplace_back(path, st);
+    ++filesDone_;
+    bytesDone_ += std::max(0LL, st.inputBytes);
+  }
+
+  void addOutput(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    outputs_.emplace_back(path, fileSize(path));
+  }
+
+  double elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+  // `total` carries the run totals, including write time spent outside ConvertFile().
+  bool write(const std::string& path, const FileStats& total) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    const double wall = elapsed();
+    long long written = 0;
+    for (const auto& o : outputs_) written += std::max(0LL, o.second);
+
+    out << "{\n";
+    for (const auto& kv : info) out << "  " << quote(kv.first) << ": " << quote(kv.second) << ",\n";
+    out << "  \"wall_seconds\": " << wall << ",\n"
+        << "  \"events\": " << total.events << ",\n"
+        << "  \"kept\": " << total.kept << ",\n"
+        << "  \"events_per_second\": " << (wall > 0 ? total.events / wall : 0.) << ",\n"
+        << "  \"input_bytes\": " << total.inputBytes << ",\n"
+        << "  \"bytes_written\": " << written << ",\n"
+        << "  \"peak_rss_kb\": " << peakRssKB() << ",\n"
+        << "  \"stage_seconds\": " << stages(total) << ",\n"
+        << "  \"outputs\": [";
+    for (size_t i = 0; i < outputs_.size(); ++i) {
+      out << (i ? ",\n" : "\n") << "    {\"path\": " << quote(outputs_[i].first)
+          << ", \"bytes\": " << outputs_[i].second << "}";
+    }
+    out << "\n  ],\n  \"files\": [";
+    for (size_t i = 0; i < files_.size(); ++i) {
+      const FileStats& st = files_[i].second;
+      out << (i ? ",\n" : "\n") << "    {\"path\": " << quote(files_[i].first)
+          << ", \"events\": " << st.events << ", \"kept\": " << st.kept
+          << ", \"input_bytes\": " << st.inputBytes << ", \"peak_rss_kb\": " << st.peakRss
+          << ", \"rss_kb\": " << st.rss
+          << ", \"stage_seconds\": " << stages(st) << "}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+  }
+
+ private:
+  static std::string quote(const std::string& s) {
+    std::string q = "\"";
+    for (const char c : s) {
+      if (c == '"' || c == '\\') q += '\\';
+      if (static_cast<unsigned char>(c) < 0x20) { q += ' '; continue; }
+      q += c;
+    }
+    return q + "\"";
+  }
+
+  static std::string stages(const FileStats& st) {
+    std::string s = "{";
+    char buf[64];
+    for (int i = 0; i < kNumStages; ++i) {
+      std::snprintf(buf, sizeof(buf), "%s\"%s\": %.6g", i ? ", " : "", stageName(i), st.seconds[i]);
+      s += buf;
+    }
+    return s + "}";
+  }
+
+  const std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+  mutable std::mutex                                    mutex_;
+  std::vector<std::pair<std::string, FileStats>>        files_;
+  std::vector<std::pair<std::string, long long>>        outputs_;
+
+  double                 progressEvery_ = 0.;
+  size_t                 totalFiles_    = 0;
+  long long              totalBytes_    = 0;
+  std::atomic<double>    nextPrint_{0.};
+  std::atomic<long long> events_{0};
+  std::atomic<long long> bytesDone_{0};
+  std::atomic<size_t>    filesDone_{0};
+};
+
+} // namespace h2r
@@ -0,0 +1,311 @@
+#pragma once
+// Output schemas of the converters (--schema=).
+//
+// A schema owns the output row and its column table and decides, per event,
+// which REC/MC particles end up in the row:
+//   select(banks, pick)            stage 1, particle banks only; false skips the event
+//   fill(banks, assoc, pick, row)  stage 2, REC::Track/REC::Traj decoded; false drops the row
+//
+// ScalarSchema ("scalar", default) writes one proton and one electron per event
+// as plain branches. MultiSchema ("multi") writes every electron and proton of
+// the event as variable-length columns, so the candidate choice can be redone
+// in the analysis (analysis/candidates.cxx) without converting again.
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "convert_core.h"
+#include "region.h"
+
+namespace h2r {
+
+enum class SchemaKind { kScalar, kMulti };
+
+inline bool parseSchema(const std::string& s, SchemaKind& k) {
+  if (s == "scalar") { k = SchemaKind::kScalar; return true; }
+  if (s == "multi")  { k = SchemaKind::kMulti;  return true; }
+  return false;
+}
+
+inline float magnitude(float x, float y, float z) { return std::sqrt(x*x + y*y + z*z); }
+
+// --- One output row. Each writer (the serial loop or a worker thread) owns its
+//     own copy, so branch addresses are never shared between threads. Data mode
+//     leaves the *_gen members alone and does not write them.
+struct OutRow {
+  float px_prot_gen, py_prot_gen, pz_prot_gen, p_proton_gen;
+  float px_prot_rec, py_prot_rec, pz_prot_rec, p_proton_rec;
+  float vx_prot, vy_prot, vz_prot;
+  int   pid_proton, status_proton, sector_proton;
+  int   region_proton;                          // h2r::Region of status_proton
+
+  float px_electron_gen, py_electron_gen, pz_electron_gen, p_electron_gen;
+  float px_electron_rec, py_electron_rec, pz_electron_rec, p_electron_rec;
+  int   pid_electron, status_electron;
+
+  float edge1_electron, edge2_electron, edge3_electron;
+  float edge1_proton,   edge2_proton,   edge3_proton;
+
+  float x1_proton,   y1_proton,   z1_proton;
+  float x1_electron, y1_electron, z1_electron;
+};
+
+template <class M>
+struct ScalarSchema {
+  using Mode = M;
+  using Row  = OutRow;
+
+  struct Pick { int p_rec, e_rec, p_mc, e_mc; };
+
+  // --- Output columns, in branch order; used for both TTree and RNTuple output.
+  //     Each mode keeps the branch set its old macro wrote.
+  static const std::vector<Column>& columns() {
+    if constexpr (Mode::kMC) {
+      static const std::vector<Column> cols = {
+        H2R_COLUMN(OutRow, px_prot_gen), H2R_COLUMN(OutRow, py_prot_gen), H2R_COLUMN(OutRow, pz_prot_gen),
+        H2R_COLUMN(OutRow, px_prot_rec), H2R_COLUMN(OutRow, py_prot_rec), H2R_COLUMN(OutRow, pz_prot_rec),
+        H2R_COLUMN(OutRow, p_proton_gen), H2R_COLUMN(OutRow, p_proton_rec),
+        H2R_COLUMN(OutRow, vx_prot), H2R_COLUMN(OutRow, vy_prot), H2R_COLUMN(OutRow, vz_prot),
+        H2R_COLUMN(OutRow, pid_proton), H2R_COLUMN(OutRow, status_proton), H2R_COLUMN(OutRow, sector_proton),
+        H2R_COLUMN(OutRow, region_proton),
+
+        H2R_COLUMN(OutRow, px_electron_gen), H2R_COLUMN(OutRow, py_electron_gen), H2R_COLUMN(OutRow, pz_electron_gen),
+        H2R_COLUMN(OutRow, p_electron_gen),
+        H2R_COLUMN(OutRow, px_electron_rec), H2R_COLUMN(OutRow, py_electron_rec), H2R_COLUMN(OutRow, pz_electron_rec),
+        H2R_COLUMN(OutRow, p_electron_rec),
+        H2R_COLUMN(OutRow, pid_electron), H2R_COLUMN(OutRow, status_electron),
+
+        H2R_COLUMN(OutRow, edge1_electron), H2R_COLUMN(OutRow, edge2_electron), H2R_COLUMN(OutRow, edge3_electron),
+        H2R_COLUMN(OutRow, edge1_proton),   H2R_COLUMN(OutRow, edge2_proton),   H2R_COLUMN(OutRow, edge3_proton),
+
+        H2R_COLUMN(OutRow, x1_proton),   H2R_COLUMN(OutRow, y1_proton),   H2R_COLUMN(OutRow, z1_proton),
+        H2R_COLUMN(OutRow, x1_electron), H2R_COLUMN(OutRow, y1_electron), H2R_COLUMN(OutRow, z1_electron),
+      };
+      return cols;
+    } else {
+      static const std::vector<Column> cols = {
+        H2R_COLUMN(OutRow, px_prot_rec), H2R_COLUMN(OutRow, py_prot_rec), H2R_COLUMN(OutRow, pz_prot_rec),
+        H2R_COLUMN(OutRow, p_proton_rec),
+        H2R_COLUMN(OutRow, vx_prot), H2R_COLUMN(OutRow, vy_prot), H2R_COLUMN(OutRow, vz_prot),
+        H2R_COLUMN(OutRow, pid_proton), H2R_COLUMN(OutRow, status_proton), H2R_COLUMN(OutRow, sector_proton),
+        H2R_COLUMN(OutRow, region_proton),
+
+        H2R_COLUMN(OutRow, px_electron_rec), H2R_COLUMN(OutRow, py_electron_rec), H2R_COLUMN(OutRow, pz_electron_rec),
+        H2R_COLUMN(OutRow, p_electron_rec),
+        H2R_COLUMN(OutRow, pid_electron), H2R_COLUMN(OutRow, status_electron),
+
+        H2R_COLUMN(OutRow, edge1_electron), H2R_COLUMN(OutRow, edge2_electron), H2R_COLUMN(OutRow, edge3_electron),
+        H2R_COLUMN(OutRow, edge1_proton),   H2R_COLUMN(OutRow, edge2_proton),   H2R_COLUMN(OutRow, edge3_proton),
+      };
+      return cols;
+    }
+  }
+
+  // MC: first proton/electron anywhere in REC and in MC.
+  // Data: the trigger electron must be REC row 0, the proton is the first 2212.
+  static bool select(const EventBanks<Mode>& b, Pick& k) {
+    k = Pick{-1, -1, -1, -1};
+    const int Nrec = b.REC_particle.rows();
+    if (Nrec <= 0) return false;
+
+    if constexpr (Mode::kMC) {
+      for (int i = 0; i < Nrec; ++i) {
+        const int pid = b.REC_particle.pid(i);
+        if (pid == 2212 && k.p_rec < 0) k.p_rec = i;
+        else if (pid == 11 && k.e_rec < 0) k.e_rec = i;
+        if (k.p_rec >= 0 && k.e_rec >= 0) break;
+      }
+      if (k.p_rec < 0 || k.e_rec < 0) return false;
+
+      const int Nmc = b.MC_particle.rows();
+      for (int i = 0; i < Nmc; ++i) {
+        const int pid = b.MC_particle.pid(i);
+        if (pid == 2212 && k.p_mc < 0) k.p_mc = i;
+        else if (pid == 11 && k.e_mc < 0) k.e_mc = i;
+        if (k.p_mc >= 0 && k.e_mc >= 0) break;
+      }
+      return k.p_mc >= 0 && k.e_mc >= 0;
+    } else {
+      if (b.REC_particle.pid(0) != 11) return false;
+      k.e_rec = 0;
+      for (int i = 1; i < Nrec; ++i) {
+        if (b.REC_particle.pid(i) == 2212) { k.p_rec = i; break; }
+      }
+      return k.p_rec >= 0;
+    }
+  }
+
+  static bool fill(const EventBanks<Mode>& b, const ParticleIndex& assoc, const Pick& k, OutRow& r) {
+    const auto& REC_particle = b.REC_particle;
+    const auto& REC_traj     = b.REC_traj;
+
+    // data rows need a track and a trajectory, as hipo2rootExp.c always did
+    if constexpr (!Mode::kMC) {
+      if (b.REC_track.rows() == 0 || REC_traj.rows() == 0) return false;
+    }
+
+    // --- reset all per-event sentinels (prevents carry-over)
+    r.edge1_electron = r.edge2_electron = r.edge3_electron = -1.f;
+    r.edge1_proton   = r.edge2_proton   = r.edge3_proton   = -1.f;
+    r.x1_proton = r.y1_proton = r.z1_proton = -1000.f;
+    r.x1_electron = r.y1_electron = r.z1_electron = -1000.f;
+
+    // --- fill proton
+    if constexpr (Mode::kMC) {
+      r.px_prot_gen = b.MC_particle.px(k.p_mc);
+      r.py_prot_gen = b.MC_particle.py(k.p_mc);
+      r.pz_prot_gen = b.MC_particle.pz(k.p_mc);
+      r.p_proton_gen = magnitude(r.px_prot_gen, r.py_prot_gen, r.pz_prot_gen);
+    }
+
+    r.px_prot_rec = REC_particle.px(k.p_rec);
+    r.py_prot_rec = REC_particle.py(k.p_rec);
+    r.pz_prot_rec = REC_particle.pz(k.p_rec);
+    r.p_proton_rec = magnitude(r.px_prot_rec, r.py_prot_rec, r.pz_prot_rec);
+
+    r.vx_prot = REC_particle.vx(k.p_rec);
+    r.vy_prot = REC_particle.vy(k.p_rec);
+    r.vz_prot = REC_particle.vz(k.p_rec);
+
+    r.pid_proton    = REC_particle.pid(k.p_rec);
+    r.status_proton = REC_particle.status(k.p_rec);
+    r.region_proton = regionOf(r.status_proton);
+
+    // sector from REC::Track
+    r.sector_proton = assoc.sector(k.p_rec);
+
+    // --- fill electron
+    if constexpr (Mode::kMC) {
+      r.px_electron_gen = b.MC_particle.px(k.e_mc);
+      r.py_electron_gen = b.MC_particle.py(k.e_mc);
+      r.pz_electron_gen = b.MC_particle.pz(k.e_mc);
+      r.p_electron_gen = magnitude(r.px_electron_gen, r.py_electron_gen, r.pz_electron_gen);
+    }
+
+    r.px_electron_rec = REC_particle.px(k.e_rec);
+    r.py_electron_rec = REC_particle.py(k.e_rec);
+    r.pz_electron_rec = REC_particle.pz(k.e_rec);
+    r.p_electron_rec = magnitude(r.px_electron_rec, r.py_electron_rec, r.pz_electron_rec);
+
+    r.pid_electron    = REC_particle.pid(k.e_rec);
+    r.status_electron = REC_particle.status(k.e_rec);
+
+    // --- DC traj (detector 6), grab layer 6/18/36 and DC1 xyz
+    if (const int t = assoc.dcRow(k.e_rec, kDC_R1); t >= 0) {
+      r.edge1_electron = REC_traj.edge(t); r.x1_electron = REC_traj.x(t); r.y1_electron = REC_traj.y(t); r.z1_electron = REC_traj.z(t);
+    }
+    if (const int t = assoc.dcRow(k.e_rec, kDC_R2); t >= 0) r.edge2_electron = REC_traj.edge(t);
+    if (const int t = assoc.dcRow(k.e_rec, kDC_R3); t >= 0) r.edge3_electron = REC_traj.edge(t);
+
+    if (const int t = assoc.dcRow(k.p_rec, kDC_R1); t >= 0) {
+      r.edge1_proton = REC_traj.edge(t); r.x1_proton = REC_traj.x(t); r.y1_proton = REC_traj.y(t); r.z1_proton = REC_traj.z(t);
+    }
+    if (const int t = assoc.dcRow(k.p_rec, kDC_R2); t >= 0) r.edge2_proton = REC_traj.edge(t);
+    if (const int t = assoc.dcRow(k.p_rec, kDC_R3); t >= 0) r.edge3_proton = REC_traj.edge(t);
+    return true;
+  }
+};
+
+// --- Every electron and proton of the event. rec_* entries are in REC::Particle
+//     order and rec_index is their row there (data analyses that need the
+//     trigger electron check rec_index == 0); mc_* entries follow MC::Particle.
+//     Missing sector/DC values use the scalar schema's sentinels.
+struct MultiRow {
+  std::vector<int>   rec_index, rec_pid, rec_status, rec_sector;
+  std::vector<float> rec_px, rec_py, rec_pz, rec_vx, rec_vy, rec_vz;
+  std::vector<float> rec_edge1, rec_edge2, rec_edge3;
+  std::vector<float> rec_x1, rec_y1, rec_z1;
+
+  std::vector<int>   mc_pid;
+  std::vector<float> mc_px, mc_py, mc_pz;
+};
+
+template <class M>
+struct MultiSchema {
+  using Mode = M;
+  using Row  = MultiRow;
+
+  struct Pick {};
+
+  static bool ofInterest(int pid) { return pid == 11 || pid == 2212; }
+
+  static const std::vector<Column>& columns() {
+    static const std::vector<Column> cols = [] {
+      std::vector<Column> c = {
+        H2R_COLUMN(MultiRow, rec_index), H2R_COLUMN(MultiRow, rec_pid), H2R_COLUMN(MultiRow, rec_status),
+        H2R_COLUMN(MultiRow, rec_sector),
+        H2R_COLUMN(MultiRow, rec_px), H2R_COLUMN(MultiRow, rec_py), H2R_COLUMN(MultiRow, rec_pz),
+        H2R_COLUMN(MultiRow, rec_vx), H2R_COLUMN(MultiRow, rec_vy), H2R_COLUMN(MultiRow, rec_vz),
+        H2R_COLUMN(MultiRow, rec_edge1), H2R_COLUMN(MultiRow, rec_edge2), H2R_COLUMN(MultiRow, rec_edge3),
+        H2R_COLUMN(MultiRow, rec_x1), H2R_COLUMN(MultiRow, rec_y1), H2R_COLUMN(MultiRow, rec_z1),
+      };
+      if (Mode::kMC) {
+        c.insert(c.end(), {H2R_COLUMN(MultiRow, mc_pid),
+                           H2R_COLUMN(MultiRow, mc_px), H2R_COLUMN(MultiRow, mc_py), H2R_COLUMN(MultiRow, mc_pz)});
+      }
+      return c;
+    }();
+    return cols;
+  }
+
+  // Loosest preselection any analysis can start from: at least one REC
+  // electron and one REC proton, wherever they are in the bank.
+  static bool select(const EventBanks<Mode>& b, Pick&) {
+    bool e = false, p = false;
+    for (int i = 0, N = b.REC_particle.rows(); i < N && !(e && p); ++i) {
+      const int pid = b.REC_particle.pid(i);
+      e |= pid == 11;
+      p |= pid == 2212;
+    }
+    return e && p;
+  }
+
+  static bool fill(const EventBanks<Mode>& b, const ParticleIndex& assoc, const Pick&, MultiRow& r) {
+    const auto& REC_particle = b.REC_particle;
+    const auto& REC_traj     = b.REC_traj;
+
+    // clear() keeps the capacity, so steady state does not allocate
+    for (auto* v : {&r.rec_index, &r.rec_pid, &r.rec_status, &r.rec_sector, &r.mc_pid}) v->clear();
+    for (auto* v : {&r.rec_px, &r.rec_py, &r.rec_pz, &r.rec_vx, &r.rec_vy, &r.rec_vz,
+                    &r.rec_edge1, &r.rec_edge2, &r.rec_edge3, &r.rec_x1, &r.rec_y1, &r.rec_z1,
+                    &r.mc_px, &r.mc_py, &r.mc_pz}) v->clear();
+
+    for (int i = 0, N = REC_particle.rows(); i < N; ++i) {
+      const int pid = REC_particle.pid(i);
+      if (!ofInterest(pid)) continue;
+      r.rec_index.push_back(i);
+      r.rec_pid.push_back(pid);
+      r.rec_status.push_back(REC_particle.status(i));
+      r.rec_sector.push_back(assoc.sector(i));
+      r.rec_px.push_back(REC_particle.px(i));
+      r.rec_py.push_back(REC_particle.py(i));
+      r.rec_pz.push_back(REC_particle.pz(i));
+      r.rec_vx.push_back(REC_particle.vx(i));
+      r.rec_vy.push_back(REC_particle.vy(i));
+      r.rec_vz.push_back(REC_particle.vz(i));
+
+      const int t1 = assoc.dcRow(i, kDC_R1), t2 = assoc.dcRow(i, kDC_R2), t3 = assoc.dcRow(i, kDC_R3);
+      r.rec_edge1.push_back(t1 >= 0 ? REC_traj.edge(t1) : -1.f);
+      r.rec_edge2.push_back(t2 >= 0 ? REC_traj.edge(t2) : -1.f);
+      r.rec_edge3.push_back(t3 >= 0 ? REC_traj.edge(t3) : -1.f);
+      r.rec_x1.push_back(t1 >= 0 ? REC_traj.x(t1) : -1000.f);
+      r.rec_y1.push_back(t1 >= 0 ? REC_traj.y(t1) : -1000.f);
+      r.rec_z1.push_back(t1 >= 0 ? REC_traj.z(t1) : -1000.f);
+    }
+
+    if constexpr (Mode::kMC) {
+      for (int i = 0, N = b.MC_particle.rows(); i < N; ++i) {
+        const int pid = b.MC_particle.pid(i);
+        if (!ofInterest(pid)) continue;
+        r.mc_pid.push_back(pid);
+        r.mc_px.push_back(b.MC_particle.px(i));
+        r.mc_py.push_back(b.MC_particle.py(i));
+        r.mc_pz.push_back(b.MC_particle.pz(i));
+      }
+    }
+    return true;
+  }
+};
+
+} // namespace h2r
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""Sharded hipo2root conversion: split a .dat list, convert the shards as a job
+array (SLURM) or a local process pool, merge the outputs with `hadd -j`.
+
+    ./shard_convert.py split AlexSimuNewRunsEdge.dat work/ --shards 50 [--by size|events] [-- --threads=4]
+    ./shard_convert.py run work/ --jobs 8            # local pool, stands in for the array
+    ./shard_convert.py submit work/                  # sbatch RunsConvert.sh as an array + dependent merge
+    ./shard_convert.py status work/
+    ./shard_convert.py resubmit work/ [--local --jobs 8]   # failed/missing shards only
+    ./shard_convert.py merge work/ --out ../../data/AlexSimuNewRunsEdge.root --jobs 8
+
+A shard is done when hipo2root wrote its output and its run report
+(shard_NNN.root + shard_NNN.root.report.json); that is the only state, so
+`status`/`resubmit` work the same after a local run or a farm run.
+"""
+import argparse
+import glob
+import json
+import multiprocessing as mp
+import os
+import subprocess
+import sys
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CONFIG = "shards.json"
+
+
+# --------------------------
+# Work directory layout
+# --------------------------
+def shard_list(work, i):
+    return os.path.join(work, f"shard_{i:03d}.dat")
+
+def shard_root(work, i):
+    return os.path.join(work, f"shard_{i:03d}.root")
+
+def shard_log(work, i):
+    return os.path.join(work, f"shard_{i:03d}.log")
+
+def load_config(work):
+    with open(os.path.join(work, CONFIG)) as f:
+        return json.load(f)
+
+def shard_done(work, i):
+    report = shard_root(work, i) + ".report.json"
+    if not (os.path.isfile(shard_root(work, i)) and os.path.isfile(report)):
+        return False
+    try:
+        with open(report) as f:
+            json.load(f)
+    except ValueError:
+        return False   # report cut short, the job died while writing it
+    return True
+
+def failed_shards(work):
+    return [i for i in range(load_config(work)["shards"]) if not shard_done(work, i)]
+
+
+# --------------------------
+# split: balanced shards
+# --------------------------
+def events_from_reports(paths):
+    """Per-input event counts from earlier hipo2root run reports."""
+    events = {}
+    for path in paths:
+        with open(path) as f:
+            for entry in json.load(f).get("files", []):
+                events[entry["path"]] = entry["events"]
+    return events
+
+def events_from_catalog(path):
+    """Per-input event counts from a hipo_catalog.c catalog; files that are not "ok" map to None."""
+    events = {}
+    with open(path) as f:
+        for line in f:
+            if line.startswith("#") or not line.strip():
+                continue
+            cols = line.rstrip("\n").split("\t")
+            events[cols[0]] = int(cols[9]) if cols[3] == "ok" and cols[4] == "1" else None
+    return events
+
+def balance(weights, n):
+    """Greedy longest-first: each input goes to the currently lightest shard."""
+    shards = [[] for _ in range(n)]
+    load = [0] * n
+    for path, w in sorted(weights.items(), key=lambda kv: -kv[1]):
+        k = load.index(min(load))
+        shards[k].append(path)
+        load[k] += w
+    return shards, load
+
+def cmd_split(a):
+    with open(a.list) as f:
+        inputs = [l.strip() for l in f if l.strip()]
+    missing = [p for p in inputs if not os.path.isfile(p)]
+    for p in missing:
+        print(f"WARNING: {p} not found (kept, weighted as 0)", file=sys.stderr)
+
+    if a.catalog:
+        # known-bad inputs would only fail inside a shard
+        events = events_from_catalog(a.catalog)
+        bad = [p for p in inputs if p in events and events[p] is None]
+        for p in bad:
+            print(f"WARNING: {p} is not usable according to {a.catalog} (dropped)", file=sys.stderr)
+        inputs = [p for p in inputs if p not in bad]
+
+    sizes = {p: (os.path.getsize(p) if os.path.isfile(p) else 0) for p in inputs}
+    weights = sizes
+    if a.by == "events":
+        if a.catalog:
+            events = events_from_catalog(a.catalog)
+        else:
+            # default: the reports next to the converter's default outputs, wherever this runs from
+            reports = a.events_from
+            if reports is None:
+                reports = sorted(glob.glob(os.path.join(HERE, "..", "..", "data", "*.report.json")))
+            events = events_from_reports(reports)
+        # files without a count get the mean events/byte of the known ones
+        known = [p for p in inputs if p in events and sizes[p] > 0]
+        rate = sum(events[p] for p in known) / max(1, sum(sizes[p] for p in known)) if known else 1.0
+        unknown = sum(p not in events for p in inputs)
+        if unknown:
+            print(f"{unknown} inputs without an event count, estimated from their size", file=sys.stderr)
+        weights = {p: events.get(p, sizes[p] * rate) for p in inputs}
+
+    n = max(1, min(a.shards, len(inputs)))
+    shards, load = balance(weights, n)
+    os.makedirs(a.work, exist_ok=True)
+    order = {p: k for k, p in enumerate(inputs)}   # keep list order inside a shard
+    for i, paths in enumerate(shards):
+        with open(shard_list(a.work, i), "w") as f:
+            f.writelines(p + "\n" for p in sorted(paths, key=order.get))
+
+    extra = a.extra
+    with open(os.path.join(a.work, CONFIG), "w") as f:
+        json.dump({"list": os.path.abspath(a.list), "shards": n, "by": a.by, "args": extra}, f, indent=2)
+    print(f"{len(inputs)} inputs -> {n} shards in {a.work} (by {a.by}; "
+          f"heaviest/lightest shard {max(load) / max(1, min(load)):.2f})")
+
+
+# --------------------------
+# task: one shard (array element or pool worker)
+# --------------------------
+def run_shard(work, i):
+    cfg = load_config(work)
+    cmd = ["clas12root", "-q", "-b", "hipo2root.c",
+           f"--in={os.path.abspath(shard_list(work, i))}",
+           f"--out={os.path.abspath(shard_root(work, i))}"] + cfg["args"]
+    t0 = time.time()
+    with open(shard_log(work, i), "w") as log:
+        rc = subprocess.call(cmd, cwd=HERE, stdout=log, stderr=subprocess.STDOUT)
+    ok = rc == 0 and shard_done(work, i)
+    print(f"shard {i:03d}: {'ok' if ok else f'FAILED (exit {rc}, see {shard_log(work, i)})'} "
+          f"in {time.time() - t0:.0f}s", flush=True)
+    return ok
+
+def _run_shard(args):
+    return run_shard(*args)
+
+def run_local(work, shards, jobs):
+    with mp.Pool(processes=jobs) as pool:
+        ok = pool.map(_run_shard, [(work, i) for i in shards], chunksize=1)
+    print(f"{sum(ok)}/{len(shards)} shards converted")
+    return all(ok)
+
+def cmd_task(a):
+    i = a.index if a.index is not None else int(os.environ["SLURM_ARRAY_TASK_ID"])
+    return 0 if run_shard(a.work, i) else 1
+
+def cmd_run(a):
+    return 0 if run_local(a.work, range(load_config(a.work)["shards"]), a.jobs) else 1
+
+
+# --------------------------
+# submit / resubmit on the farm
+# --------------------------
+def sbatch(args):
+    out = subprocess.check_output(["sbatch", "--parsable"] + args, cwd=HERE, text=True)
+    return out.strip().split(";")[0]
+
+def submit(work, shards, merge_out, merge_jobs):
+    work = os.path.abspath(work)
+    array = ",".join(str(i) for i in shards)
+    job = sbatch([f"--array={array}", f"--export=ALL,SHARD_DIR={work}", "RunsConvert.sh"])
+    print(f"submitted array job {job} ({len(shards)} shards)")
+    if merge_out:
+        merge = sbatch([f"--dependency=afterok:{job}", "--job-name=HIPO_to_ROOT_merge",
+                        f"--cpus-per-task={merge_jobs}",
+                        f"--export=ALL,SHARD_DIR={work},MERGE_OUT={os.path.abspath(merge_out)},MERGE_JOBS={merge_jobs}",
+                        "RunsConvert.sh"])
+        print(f"submitted merge job {merge} (runs after {job} succeeds)")
+
+def cmd_submit(a):
+    submit(a.work, range(load_config(a.work)["shards"]), a.out, a.jobs)
+    return 0
+
+def cmd_resubmit(a):
+    failed = failed_shards(a.work)
+    if not failed:
+        print("no failed shards")
+        return 0
+    print("resubmitting shards " + " ".join(f"{i:03d}" for i in failed))
+    if a.local:
+        return 0 if run_local(a.work, failed, a.jobs) else 1
+    submit(a.work, failed, a.out, a.jobs)
+    return 0
+
+def cmd_status(a):
+    n = load_config(a.work)["shards"]
+    failed = failed_shards(a.work)
+    print(f"{n - len(failed)}/{n} shards done")
+    for i in failed:
+        print(f"  shard {i:03d}: missing or failed ({shard_log(a.work, i)})")
+    return 0 if not failed else 1
+
+
+# --------------------------
+# merge: parallel hadd
+# --------------------------
+def cmd_merge(a):
+    failed = failed_shards(a.work)
+    if failed and not a.partial:
+        print(f"ERROR: {len(failed)} shards not done, run `resubmit` first (or --partial)", file=sys.stderr)
+        return 1
+    outputs = [shard_root(a.work, i) for i in range(load_config(a.work)["shards"]) if i not in failed]
+    # hadd -j merges in parallel worker processes; no -k: a shard that passed the
+    # checks above but cannot be read must fail the merge, not shorten it
+    cmd = ["hadd", "-f", "-j", str(a.jobs), a.out] + outputs
+    print(" ".join(cmd[:5]) + f" <{len(outputs)} shards>")
+    return subprocess.call(cmd)
+
+
+def main():
+    p = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = p.add_subparsers(dest="cmd", required=True)
+
+    s = sub.add_parser("split", help="split a .dat list into balanced shards")
+    s.add_argument("list")
+    s.add_argument("work")
+    s.add_argument("--shards", type=int, default=mp.cpu_count())
+    s.add_argument("--by", choices=["size", "events"], default="size")
+    s.add_argument("--events-from", nargs="*",
+                   help="hipo2root run reports to take per-file event counts from (--by events;"
+                        " default: data/*.report.json of this repository)")
+    s.add_argument("--catalog", help="hipo_catalog.c output: drops bad inputs, event counts for --by events")
+    s.set_defaults(func=cmd_split)
+
+    s = sub.add_parser("task", help="convert one shard (SLURM_ARRAY_TASK_ID by default)")
+    s.add_argument("work")
+    s.add_argument("index", type=int, nargs="?")
+    s.set_defaults(func=cmd_task)
+
+    s = sub.add_parser("run", help="convert all shards with a local process pool")
+    s.add_argument("work")
+    s.add_argument("--jobs", type=int, default=mp.cpu_count())
+    s.set_defaults(func=cmd_run)
+
+    for name, func in (("submit", cmd_submit), ("resubmit", cmd_resubmit)):
+        s = sub.add_parser(name, help=f"{name} the shard array with sbatch")
+        s.add_argument("work")
+        s.add_argument("--out", help="also submit a dependent merge job writing this file")
+        s.add_argument("--jobs", type=int, default=8, help="hadd workers (or local pool size)")
+        if name == "resubmit":
+            s.add_argument("--local", action="store_true", help="rerun the failed shards here")
+        s.set_defaults(func=func)
+
+    s = sub.add_parser("status", help="list shards that are not done")
+    s.add_argument("work")
+    s.set_defaults(func=cmd_status)
+
+    s = sub.add_parser("merge", help="hadd the shard outputs")
+    s.add_argument("work")
+    s.add_argument("--out", required=True)
+    s.add_argument("--jobs", type=int, default=mp.cpu_count())
+    s.add_argument("--partial", action="store_true", help="merge the done shards even if some failed")
+    s.set_defaults(func=cmd_merge)
+
+    # everything after "--" is passed to hipo2root unchanged (split only)
+    argv = sys.argv[1:]
+    extra = argv[argv.index("--") + 1:] if "--" in argv else []
+    a = p.parse_args(argv[:len(argv) - len(extra)][:-1] if "--" in argv else argv)
+    a.extra = extra
+    sys.exit(a.func(a))
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,188 @@
+#pragma once
+// Manifest of a sharded conversion (--shard-dir).
+//
+// Every completed shard is recorded with the inputs it holds, each input's size
+// and mtime at conversion time and its event counts. A re-run only converts
+// inputs that are new or changed; a shard with a changed input is deleted and
+// all of its inputs are converted again. The manifest is rewritten after every
+// shard, so a job killed mid-way resumes from the last completed shard. A shard
+// holding an input that is no longer in the list is dropped too, so the shard
+// directory always matches the current list, and *.part files left by a killed
+// job are removed before converting.
+//
+// <shard-dir>/manifest.tsv, one line per input:
+//   input  size  mtime  events  kept  shard
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace h2r {
+
+class ShardManifest {
+ public:
+  struct Input {
+    std::string path;
+    long long   size   = -1;
+    long long   mtime  = -1;
+    long long   events = 0;
+    long long   kept   = 0;
+  };
+
+  struct Shard {
+    std::string              name;     // file name inside the shard directory
+    std::vector<std::string> inputs;
+  };
+
+  explicit ShardManifest(std::string dir) : dir_(std::move(dir)) {}
+
+  std::string manifestPath() const { return dir_ + "/manifest.tsv"; }
+  std::string shardPath(const std::string& name) const { return dir_ + "/" + name; }
+
+  static bool stamp(const std::string& path, long long& size, long long& mtime) {
+    struct stat sb;
+    if (stat(path.c_str(), &sb) != 0) return false;
+    size  = static_cast<long long>(sb.st_size);
+    mtime = static_cast<long long>(sb.st_mtime);
+    return true;
+  }
+
+  void load() {
+    std::ifstream in(manifestPath());
+    for (std::string line; std::getline(in, line);) {
+      if (line.empty() || line[0] == '#') continue;
+      std::istringstream ls(line);
+      Input in_; std::string shard;
+      std::getline(ls, in_.path, '\t');
+      ls >> in_.size >> in_.mtime >> in_.events >> in_.kept >> shard;
+      if (!in_.path.empty() && !shard.empty()) shards_[shard].push_back(in_);
+    }
+  }
+
+  // Decide what has to be converted for `inputs`: up-to-date shards are kept,
+  // shards with a changed or vanished input, or with an input no longer in
+  // `inputs`, are dropped (file and entries), and all remaining inputs are
+  // grouped `perShard` at a time in list order.
+  std::vector<Shard> plan(const std::vector<std::string>& inputs, int perShard) {
+    sweepPartial();
+
+    std::map<std::string, std::string> owner;   // input -> shard
+    for (const auto& kv : shards_)
+      for (const auto& in : kv.second) owner[in.path] = kv.first;
+
+    const std::set<std::string> listed(inputs.begin(), inputs.end());
+    std::set<std::string> stale;
+    for (const auto& kv : shards_) {
+      for (const auto& in : kv.second) {
+        long long size, mtime;
+        if (!listed.count(in.path)) {
+          std::cerr << "WARNING: " << in.path << " is no longer in the input list, dropping "
+                    << kv.first << "\n";
+          stale.insert(kv.first);
+        } else if (!stamp(in.path, size, mtime) || size != in.size || mtime != in.mtime) {
+          stale.insert(kv.first);
+        }
+      }
+      long long size, mtime;
+      if (!stamp(shardPath(kv.first), size, mtime)) stale.insert(kv.first);
+    }
+    for (const auto& name : stale) {
+      std::remove(shardPath(name).c_str());
+      shards_.erase(name);
+    }
+    if (!stale.empty()) save();   // readers of the manifest must not see the removed shards
+
+    std::vector<std::string> todo;
+    for (const auto& path : inputs) {
+      auto it = owner.find(path);
+      if (it == owner.end() || stale.count(it->second)) todo.push_back(path);
+    }
+
+    std::vector<Shard> out;
+    const size_t n = std::max(perShard, 1);
+    for (size_t i = 0; i < todo.size(); i += n) {
+      Shard s;
+      s.name = nextName();
+      s.inputs.assign(todo.begin() + i, todo.begin() + std::min(todo.size(), i + n));
+      out.push_back(std::move(s));
+    }
+    return out;
+  }
+
+  // Record a finished shard and rewrite the manifest. `inputs` carry the stamp()
+  // taken before they were converted; an input without one is never recorded,
+  // since no later stamp could match it. On failure the shard is not recorded
+  // at all. Thread-safe.
+  bool commit(const std::string& shard, std::vector<Input> inputs) {
+    inputs.erase(std::remove_if(inputs.begin(), inputs.end(), [](const Input& in) { return in.size < 0; }),
+                 inputs.end());
+    std::lock_guard<std::mutex> lock(mutex_);
+    shards_[shard] = std::move(inputs);
+    if (save()) return true;
+    shards_.erase(shard);   // the caller deletes the shard file
+    return false;
+  }
+
+  // All shard files currently in the manifest, in name order.
+  std::vector<std::string> shardFiles() const {
+    std::vector<std::string> files;
+    for (const auto& kv : shards_) files.push_back(shardPath(kv.first));
+    return files;
+  }
+
+  size_t inputCount() const {
+    size_t n = 0;
+    for (const auto& kv : shards_) n += kv.second.size();
+    return n;
+  }
+
+ private:
+  // Shards a killed job was still writing: never in the manifest, never complete.
+  void sweepPartial() const {
+    DIR* dir = opendir(dir_.c_str());
+    if (!dir) return;
+    while (const dirent* entry = readdir(dir)) {
+      const std::string name = entry->d_name;
+      if (name.size() > 5 && name.compare(name.size() - 5, 5, ".part") == 0) std::remove(shardPath(name).c_str());
+    }
+    closedir(dir);
+  }
+
+  std::string nextName() {
+    char buf[32];
+    do { std::snprintf(buf, sizeof(buf), "shard_%05d.root", nextId_++); } while (shards_.count(buf));
+    return buf;
+  }
+
+  bool save() const {
+    const std::string tmp = manifestPath() + ".tmp";
+    {
+      std::ofstream out(tmp);
+      if (!out.is_open()) return false;
+      out << "# input\tsize\tmtime\tevents\tkept\tshard\n";
+      for (const auto& kv : shards_)
+        for (const auto& in : kv.second)
+          out << in.path << '\t' << in.size << '\t' << in.mtime << '\t'
+              << in.events << '\t' << in.kept << '\t' << kv.first << '\n';
+      if (!out) return false;
+    }
+    return std::rename(tmp.c_str(), manifestPath().c_str()) == 0;
+  }
+
+  std::string                                dir_;
+  std::map<std::string, std::vector<Input>>  shards_;
+  int                                        nextId_ = 0;
+  std::mutex                                 mutex_;
+};
+
+} // namespace h2r
@@ -0,0 +1,128 @@
+#pragma once
+// Sidecar index of the events that passed the converter's e+p preselection.
+//
+// A conversion run with --skim-out=<file> records, for every input file, its
+// size, the number of events it holds and the ordinals of its candidate events.
+// A later run with --skim-in=<file> jumps straight to those events with
+// hipo::reader::gotoEvent() (which resolves the record itself) and never opens
+// files without candidates. Files that are missing from the index, or whose
+// size changed since it was written, are converted in full.
+//
+// Candidates depend on the selection: MC and data mode pick the e+p pair
+// differently, and --schema=multi keeps any event with a REC e and p. The header
+// records the mode and schema of the run that wrote the index, and an index is
+// only used by a run with the same ones; with another selection it would drop
+// events without notice.
+//
+// Text format, a header line, then one block per file:
+//   # hipo2root skim index v1 mode=<mc|data> schema=<scalar|multi>
+//   F <file id> <size in bytes> <events in file> <n candidates> <path>
+//   E <event> <event> ...            (omitted when n candidates == 0)
+
+#include <sys/stat.h>
+
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace h2r {
+
+class SkimIndex {
+ public:
+  struct FileEntry {
+    long long        size   = -1;
+    long long        events = 0;    // events in the file, for reporting
+    std::vector<int> candidates;    // ascending event ordinals
+  };
+
+  std::string mode;     // selection of the candidates: "mc" or "data"
+  std::string schema;   // "scalar" or "multi"
+
+  static long long fileSize(const std::string& path) {
+    struct stat sb;
+    return stat(path.c_str(), &sb) == 0 ? static_cast<long long>(sb.st_size) : -1;
+  }
+
+  bool load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+    FileEntry* cur = nullptr;
+    for (std::string line; std::getline(in, line);) {
+      if (line.rfind("# hipo2root skim index", 0) == 0) {
+        std::istringstream hs(line);
+        for (std::string word; hs >> word;) {
+          if (word.rfind("mode=", 0) == 0)   mode   = word.substr(5);
+          if (word.rfind("schema=", 0) == 0) schema = word.substr(7);
+        }
+        continue;
+      }
+      if (line.empty() || line[0] == '#') continue;
+      std::istringstream ls(line);
+      char tag; ls >> tag;
+      if (tag == 'F') {
+        int id; size_t n; FileEntry e; std::string file;
+        ls >> id >> e.size >> e.events >> n;
+        std::getline(ls >> std::ws, file);
+        e.candidates.reserve(n);
+        cur = &(files_[file] = std::move(e));
+      } else if (tag == 'E' && cur) {
+        for (int ev; ls >> ev;) cur->candidates.push_back(ev);
+      }
+    }
+    return true;
+  }
+
+  bool save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << "# hipo2root skim index v1 mode=" << mode << " schema=" << schema << "\n";
+    int id = 0;
+    for (const auto& kv : files_) {
+      const FileEntry& e = kv.second;
+      out << "F " << id++ << ' ' << e.size << ' ' << e.events << ' '
+          << e.candidates.size() << ' ' << kv.first << '\n';
+      if (e.candidates.empty()) continue;
+      out << 'E';
+      for (int ev : e.candidates) out << ' ' << ev;
+      out << '\n';
+    }
+    return static_cast<bool>(out);
+  }
+
+  // Why a loaded index cannot serve a run with this mode and schema, nullptr if it can.
+  // Indexes written before the header carried the selection are refused as well.
+  const char* mismatch(const std::string& runMode, const std::string& runSchema) const {
+    if (mode.empty() || schema.empty()) return "does not record the selection it was written with";
+    if (mode != runMode)                return "was written in another mode (--data)";
+    if (schema != runSchema)            return "was written with another --schema";
+    return nullptr;
+  }
+
+  // Entry usable for seeking: present and the file on disk still has the same size.
+  const FileEntry* lookup(const std::string& file) const {
+    auto it = files_.find(file);
+    if (it == files_.end() || it->second.size < 0 || it->second.size != fileSize(file)) return nullptr;
+    return &it->second;
+  }
+
+  // Thread-safe; called by every worker once its file is done.
+  void record(const std::string& file, long long events, std::vector<int> candidates) {
+    FileEntry e;
+    e.size       = fileSize(file);
+    e.events     = events;
+    e.candidates = std::move(candidates);
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_[file] = std::move(e);
+  }
+
+  size_t size() const { return files_.size(); }
+
+ private:
+  std::map<std::string, FileEntry> files_;
+  std::mutex                       mutex_;
+};
+
+} // namespace h2r